@@ -65,7 +65,8 @@ void showSimpleExample() {
     SfCTable        lTable("Table Simple Example", lAttr);
 
     // Define the header line with three columns
-    lTable << hdr << "Company" << "Contact" << "Contry";
+    // The country repeats, so the rows keep a code of the column's dictionary
+    lTable << hdr << "Company" << "Contact" << SfCTable::DICT << "Contry";
 
     // Add rows to the table
     lTable << row << "Alfreds Futterkiste"          << "Maria Anders"    << "Germany";
@@ -163,9 +164,8 @@ void mainLoop() {
         lPrompt << SfCTable::R_PROMPT << row << "> ";
         lPrompt.print();
 
-        lPrompt.getInput(aCmd);
-
-        if (aCmd == "exit") {
+        // Without timeout getInput only fails if the input is closed
+        if (!lPrompt.getInput(aCmd) || aCmd == "exit") {
             break;
         }
         else if (aCmd == "example") {
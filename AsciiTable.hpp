@@ -50,5 +50,11 @@ typedef unsigned int            SAP_UINT;
 typedef int                     SAP_INT;
 typedef const SAP_UINT          SAP_CUINT;
 
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define SF_STRING_VIEW
+typedef string_view             TStringView;
+#endif
+
 #include "sfntat.hpp"
 #include "sfuxat.hpp"
@@ -60,23 +60,58 @@ SAP_UINT SfCTable::setColor ( const EColor    aColor ) {
         break;
     }
 
-    switch (lNewColor)
-    {
-    case COLOR_INVERSE: lAttr = 8 << 4 | 0xF; break;
-    case COLOR_CHAR:
-    case COLOR_BRIGHT:  lAttr = 7 << 4 | 0x0; break;
-    case COLOR_DARK:    lAttr = 8 << 4 | 0x0; break;
-    case COLOR_RED:     lAttr = 4 << 4 | 0xF; break;
-    case COLOR_GREEN:   lAttr = 2 << 4 | 0xF; break;
-    case COLOR_NONE:
+    if (lNewColor == COLOR_NONE) {
         return sCurAttr;  // keep current color
-    default:            lAttr = 7 << 4 | 0x0; break;
     }
 
+    lAttr    = colorAttr(lNewColor);
     sCurAttr = lAttr;
     return setAttr(lAttr);
 }
 
+//------------------------------------------------------------------------------
+// SfCTable::colorAttr
+//------------------------------------------------------------------------------
+SAP_UINT SfCTable::colorAttr ( const EColor    aColor ) {
+    switch (aColor)
+    {
+    case COLOR_INVERSE: return 8 << 4 | 0xF;
+    case COLOR_CHAR:
+    case COLOR_BRIGHT:  return 7 << 4 | 0x0;
+    case COLOR_DARK:    return 8 << 4 | 0x0;
+    case COLOR_RED:     return 4 << 4 | 0xF;
+    case COLOR_GREEN:   return 2 << 4 | 0xF;
+    case COLOR_BLUE:    return 1 << 4 | 0xF;
+    default:            return 7 << 4 | 0x0;
+    }
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::rgbAttr
+//------------------------------------------------------------------------------
+SAP_UINT SfCTable::rgbAttr ( const SAP_UINT  aRgb ) {
+    SAP_UINT  lRed   = 0xFF & (aRgb >> 16);
+    SAP_UINT  lGreen = 0xFF & (aRgb >> 8);
+
+    if (lRed > 2 * lGreen) {
+        return 4 << 4 | 0xF;
+    }
+
+    if (lGreen > 2 * lRed) {
+        return 2 << 4 | 0xF;
+    }
+    return 6 << 4 | 0x0;    // yellow
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::appendCellColor
+// The console colors cells by attributes, see endline
+//------------------------------------------------------------------------------
+void SfCTable::appendCellColor(
+        TString&        arLine,
+        const SAP_UINT  aColor ) {
+}
+
 //------------------------------------------------------------------------------
 // SfCTable::setAttr
 //------------------------------------------------------------------------------
@@ -86,6 +121,10 @@ SAP_UINT SfCTable::setAttr( const SAP_UINT aAttr ){
     SAP_UINT      lOldAttr;
     HANDLE        hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
 
+    if (getTermColors() == TERM_COLORS_NONE) {
+        return sCurAttr;
+    }
+
     GetConsoleScreenBufferInfo(hStdout, &lConsoleScreenBufferInfo);
     lOldAttr = (SAP_UINT) lConsoleScreenBufferInfo.wAttributes;
 
@@ -93,6 +132,118 @@ SAP_UINT SfCTable::setAttr( const SAP_UINT aAttr ){
     return lOldAttr;
 }
 
+//------------------------------------------------------------------------------
+// SfCTable::detectTermColors
+// Colors are console attributes, a redirected output has none
+//------------------------------------------------------------------------------
+SfCTable::ETermColors SfCTable::detectTermColors( void ) {
+    const SAP_UC*   lpNoColor = getenv("NO_COLOR");
+    DWORD           lMode;
+
+    if (lpNoColor != NULL && *lpNoColor != '\0') {
+        return TERM_COLORS_NONE;
+    }
+
+    if (!GetConsoleMode(GetStdHandle(STD_OUTPUT_HANDLE), &lMode)) {
+        return TERM_COLORS_NONE;
+    }
+    return TERM_COLORS_8;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::buildPalette
+// The console colors are set by attributes, there are no escape sequences
+//------------------------------------------------------------------------------
+void SfCTable::buildPalette( void ) {
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::getTermWidth
+//------------------------------------------------------------------------------
+TStringSize SfCTable::getTermWidth( void ) {
+    CONSOLE_SCREEN_BUFFER_INFO lConsoleScreenBufferInfo;
+    HANDLE        hStdout = GetStdHandle(STD_OUTPUT_HANDLE);
+
+    if (GetConsoleScreenBufferInfo(hStdout, &lConsoleScreenBufferInfo)) {
+        return lConsoleScreenBufferInfo.srWindow.Right - lConsoleScreenBufferInfo.srWindow.Left + 1;
+    }
+    return 80;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::getInputFd
+//------------------------------------------------------------------------------
+SAP_INT SfCTable::getInputFd( void ) {
+    return _fileno(stdin);
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::readInput
+// The console is signaled for any input event, so wait for a key press and
+// discard the other events. Once a key is pressed the console reads the line
+// up to the enter key. Pipes cannot be waited for and are polled.
+//------------------------------------------------------------------------------
+SAP_INT SfCTable::readInput( const SAP_INT aTimeout ) {
+    SAP_UC          lA7Buffer[256];
+    HANDLE          hStdin    = GetStdHandle(STD_INPUT_HANDLE);
+    ULONGLONG       lDeadline = GetTickCount64() + (aTimeout > 0 ? aTimeout : 0);
+    INPUT_RECORD    lRecord;
+    DWORD           lMode;
+    DWORD           lNrRead;
+    DWORD           lAvail;
+    DWORD           lWait;
+
+    if (sInputEof) {
+        return -1;
+    }
+
+    if (GetConsoleMode(hStdin, &lMode)) {
+        for (;;) {
+            lWait = INFINITE;
+            if (aTimeout >= 0) {
+                lWait = (GetTickCount64() < lDeadline) ? (DWORD)(lDeadline - GetTickCount64()) : 0;
+            }
+
+            if (WaitForSingleObject(hStdin, lWait) != WAIT_OBJECT_0) {
+                return 0;
+            }
+
+            if (!PeekConsoleInput(hStdin, &lRecord, 1, &lNrRead) || lNrRead == 0) {
+                continue;
+            }
+
+            if (lRecord.EventType == KEY_EVENT && lRecord.Event.KeyEvent.bKeyDown) {
+                break;
+            }
+            ReadConsoleInput(hStdin, &lRecord, 1, &lNrRead);
+        }
+    }
+    else if (GetFileType(hStdin) == FILE_TYPE_PIPE) {
+        for (;;) {
+            if (!PeekNamedPipe(hStdin, NULL, 0, NULL, &lAvail, NULL)) {
+                sInputEof = true;
+                return -1;
+            }
+
+            if (lAvail > 0) {
+                break;
+            }
+
+            if (aTimeout >= 0 && GetTickCount64() >= lDeadline) {
+                return 0;
+            }
+            Sleep(10);
+        }
+    }
+
+    if (!ReadFile(hStdin, lA7Buffer, sizeof(lA7Buffer), &lNrRead, NULL) || lNrRead == 0) {
+        sInputEof = true;
+        return -1;
+    }
+    sInput.append(lA7Buffer, lNrRead);
+    return (SAP_INT)lNrRead;
+}
+
 //------------------------------------------------------------------------------
 // SfCTable::endline
 //------------------------------------------------------------------------------
@@ -106,11 +257,32 @@ void SfCTable::endline( const EColor aColor ) {
 
     hStdout  = GetStdHandle(STD_OUTPUT_HANDLE);
     lNrBytes = (mOutput.str()).size();
+
+    mLinesOut++;
+    mBytesOut += lBuffer.size() + 1;
+    SF_STAT(addStat(statsPtr(), STAT_BYTES, lBuffer.size() + 1);)
     
     if (spOut != NULL) {
-        fprintf(spOut, "\n%s", mOutput.str().c_str());
+        writeOut(spOut, "\n" + lBuffer, statsPtr());
     } 
+    else if (spAsync != NULL) {
+        //----------------------------------------------------------------------
+        // Console attributes are a state of the console and cannot be
+        // queued with the text, the writer thread prints without colors
+        //----------------------------------------------------------------------
+        writeOut(NULL, "\n" + lBuffer, statsPtr());
+    }
+    else if (getTermColors() == TERM_COLORS_NONE) {
+        WriteFile(hStdout, ("\n" + lBuffer).c_str(), lNrBytes + 1, &lNrWritten, NULL);
+        SF_STAT(addStat(statsPtr(), STAT_WRITES, 1);)
+    }
     else {
+        //----------------------------------------------------------------------
+        // Colors are console attributes, there are no escape bytes
+        //----------------------------------------------------------------------
+        SF_STAT(TStatTimer lTimer(statsPtr(), STAT_NS_IO);)
+        SF_STAT(addStat(statsPtr(), STAT_WRITES, (aColor == COLOR_CHAR) ? lBuffer.size() + 1 : 2);)
+
         if (aColor == COLOR_CHAR) {
             //----------------------------------------------------------------------
             // COLOR_CHAR sets color for different characters
@@ -138,9 +310,40 @@ void SfCTable::endline( const EColor aColor ) {
             setAttr(0);
             WriteFile(hStdout, "\n", 1, &lNrWritten, NULL);
             setColor(aColor);
-            WriteFile(hStdout, lBuffer.c_str(), lNrBytes, &lNrWritten, NULL);
+            lAttr = sCurAttr;
+
+            //------------------------------------------------------------------
+            // Cells colored by rules are written with their own attributes
+            //------------------------------------------------------------------
+            DWORD   lPos = 0;
+
+            if (mpRules) {
+                for (size_t iSpan = 0; iSpan < mpRules->mSpans.size(); iSpan++) {
+                    DWORD       lEnd   = lNrBytes;
+                    SAP_UINT    lColor = mpRules->mSpans[iSpan].second;
+
+                    if (mpRules->mSpans[iSpan].first < lNrBytes) {
+                        lEnd = (DWORD)mpRules->mSpans[iSpan].first;
+                    }
+
+                    WriteFile(hStdout, lBuffer.c_str() + lPos, lEnd - lPos, &lNrWritten, NULL);
+                    lPos = lEnd;
+
+                    if (lColor == 0) {
+                        setAttr(lAttr);
+                    }
+                    else {
+                        setAttr((lColor & CELL_RGB) ? rgbAttr(lColor & 0xFFFFFF) : (lColor & 0xFF));
+                    }
+                }
+            }
+            WriteFile(hStdout, lBuffer.c_str() + lPos, lNrBytes - lPos, &lNrWritten, NULL);
         }
     }
+
+    if (mpRules) {
+        mpRules->mSpans.clear();
+    }
     mOutput.str("");
 }
 
@@ -26,12 +26,17 @@
 
 #ifdef SAPonUNIX
 #include <iostream>
+#include <cstdlib>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
 using namespace std;
 
 //------------------------------------------------------------------------------
-// SfCTable::setColor
+// SfCTable::evalColor
 //------------------------------------------------------------------------------
-SAP_UINT SfCTable::setColor( const EColor        aColor ) {
+SAP_UINT SfCTable::evalColor( const EColor        aColor ) {
     SAP_UINT                lAttr;
     EColor                lNewColor = aColor;
 
@@ -51,20 +56,87 @@ SAP_UINT SfCTable::setColor( const EColor        aColor ) {
             break;
     }
 
-    switch (lNewColor)
-    {
-    case COLOR_INVERSE:     lAttr = 8 << 4 | 7;     break;  // cyan   - white 
-    case COLOR_CHAR:        lAttr = 0 << 4 | 7;     break;  // black  - white
-    case COLOR_BRIGHT:      lAttr = 7 << 4 | 0;     break;  // gray   - black
-    case COLOR_DARK:        lAttr = 8 << 4 | 0;     break;  // cyan   - black
-    case COLOR_RED:         lAttr = 4 << 4 | 7;     break;  // red    - white
-    case COLOR_GREEN:       lAttr = 2 << 4 | 7;     break;  // green  - white
-    case COLOR_NONE:
+    if (lNewColor == COLOR_NONE) {
         return sCurAttr;        // keep current color
-    default:                lAttr = 7 << 4 | 0;     break;  // gray   - black
     }
 
+    lAttr    = colorAttr(lNewColor);
     sCurAttr = lAttr;
+    return lAttr;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::colorAttr
+//------------------------------------------------------------------------------
+SAP_UINT SfCTable::colorAttr( const EColor        aColor ) {
+    switch (aColor)
+    {
+    case COLOR_INVERSE:     return 8 << 4 | 7;      // cyan   - white 
+    case COLOR_CHAR:        return 0 << 4 | 7;      // black  - white
+    case COLOR_BRIGHT:      return 7 << 4 | 0;      // gray   - black
+    case COLOR_DARK:        return 8 << 4 | 0;      // cyan   - black
+    case COLOR_RED:         return 4 << 4 | 7;      // red    - white
+    case COLOR_GREEN:       return 2 << 4 | 7;      // green  - white
+    case COLOR_BLUE:        return 1 << 4 | 7;      // blue   - white
+    default:                return 7 << 4 | 0;      // gray   - black
+    }
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::rgbAttr
+//------------------------------------------------------------------------------
+SAP_UINT SfCTable::rgbAttr( const SAP_UINT aRgb ) {
+    SAP_UINT  lRed   = 0xFF & (aRgb >> 16);
+    SAP_UINT  lGreen = 0xFF & (aRgb >> 8);
+
+    if (lRed > 2 * lGreen) {
+        return 4 << 4 | 7;      // red    - white
+    }
+
+    if (lGreen > 2 * lRed) {
+        return 2 << 4 | 7;      // green  - white
+    }
+    return 8 << 4 | 0;          // yellow - black
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::appendCellColor
+// 24 bit colors are reduced to the xterm color cube or to the basic colors
+//------------------------------------------------------------------------------
+void SfCTable::appendCellColor(
+        TString&        arLine,
+        const SAP_UINT  aColor ) {
+    SAP_UC    lCode[48];
+    SAP_UINT  lRed   = 0xFF & (aColor >> 16);
+    SAP_UINT  lGreen = 0xFF & (aColor >> 8);
+    SAP_UINT  lBlue  = 0xFF & (aColor);
+
+    if ((aColor & CELL_RGB) == 0) {
+        arLine += sPalette[aColor & 0xFF];
+    }
+    else if (sTermColors == TERM_COLORS_TRUE) {
+        snprintf(lCode, sizeof(lCode), "\033[48;2;%u;%u;%um\033[30m", lRed, lGreen, lBlue);
+        arLine += lCode;
+    }
+    else if (sTermColors == TERM_COLORS_256) {
+        snprintf(lCode, sizeof(lCode), "\033[48;5;%um\033[30m",
+            16 + 36 * (lRed * 5 / 255) + 6 * (lGreen * 5 / 255) + (lBlue * 5 / 255));
+        arLine += lCode;
+    }
+    else {
+        arLine += sPalette[rgbAttr(aColor & 0xFFFFFF)];
+    }
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::setColor
+//------------------------------------------------------------------------------
+SAP_UINT SfCTable::setColor( const EColor        aColor ) {
+    SAP_UINT                lAttr = evalColor(aColor);
+
+    if (aColor == COLOR_NONE) {
+        return lAttr;           // keep current color
+    }
     return setAttr(lAttr);
 }
 
@@ -73,85 +145,252 @@ SAP_UINT SfCTable::setColor( const EColor        aColor ) {
 //------------------------------------------------------------------------------
 SAP_UINT SfCTable::setAttr( const SAP_UINT aAttr ) {
     SAP_UINT  lOldAttr    = sCurAttr;
-    SAP_UINT  lForeground = 0xF & (aAttr);
-    SAP_UINT  lBackground = 0xF & (aAttr >> 4);
+    TString   lCode;
+
+    appendAttr(lCode, aAttr);
+    if (!lCode.empty()) {
+        writeOut(NULL, std::move(lCode));
+    }
+    return (aAttr == 0) ? 0 : lOldAttr;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::appendAttr
+//------------------------------------------------------------------------------
+void SfCTable::appendAttr(
+        TString&        arLine,
+        const SAP_UINT  aAttr ) {
+    getTermColors();
+    arLine += sPalette[aAttr & 0xFF];
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::detectTermColors
+// Escapes only make sense on a terminal. NO_COLOR (no-color.org) turns them
+// off, COLORTERM and TERM tell the color depth.
+//------------------------------------------------------------------------------
+SfCTable::ETermColors SfCTable::detectTermColors( void ) {
+    const SAP_UC*   lpNoColor   = getenv("NO_COLOR");
+    const SAP_UC*   lpColorTerm = getenv("COLORTERM");
+    const SAP_UC*   lpTerm      = getenv("TERM");
+
+    if (lpNoColor != NULL && *lpNoColor != '\0') {
+        return TERM_COLORS_NONE;
+    }
 
 #ifdef SAPwithPASE400
     if (!isatty(0)) {
-        return 0;
+        return TERM_COLORS_NONE;
     }
 #endif
 
-    if (aAttr == 0) {
-        cout << "\033[0m";
-        return 0;
+    if (!isatty(STDOUT_FILENO)) {
+        return TERM_COLORS_NONE;
     }
 
-    switch (lBackground) {
-    case 0: cout << "\033[40m";  break; // black
-    case 1: cout << "\033[44m";  break; // blue
-    case 2: cout << "\033[42m";  break; // green
-    case 4: cout << "\033[41m";  break; // red
-    case 7: cout << "\033[47m";  break; // gray
-    case 8: cout << "\033[43m";  break; // yellow
-    default:
-            cout << "\033[40m";  break; // black
+    if (lpTerm == NULL || *lpTerm == '\0' || strcmp(lpTerm, "dumb") == 0) {
+        return TERM_COLORS_NONE;
     }
 
-    switch (lForeground) 
-    {
-    case 0: cout << "\033[30m";  break; // black
-    case 1: cout << "\033[34m";  break; // blue
-    case 2: cout << "\033[32m";  break; // green
-    case 4: cout << "\033[31m";  break; // red
-    case 7: cout << "\033[37m";  break; // white
-    default:
-            cout << "\033[37m";  break; // white
+    if (lpColorTerm != NULL && (strcmp(lpColorTerm, "truecolor") == 0 || strcmp(lpColorTerm, "24bit") == 0)) {
+        return TERM_COLORS_TRUE;
     }
 
-    return lOldAttr;
+    if (strstr(lpTerm, "256color") != NULL) {
+        return TERM_COLORS_256;
+    }
+    return TERM_COLORS_8;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::buildPalette
+// The table colors are the basic ANSI colors on every color depth
+//------------------------------------------------------------------------------
+void SfCTable::buildPalette( void ) {
+    for (SAP_UINT lAttr = 0; lAttr < 256; lAttr++) {
+        TString&  lrCode      = sPalette[lAttr];
+        SAP_UINT  lForeground = 0xF & (lAttr);
+        SAP_UINT  lBackground = 0xF & (lAttr >> 4);
+
+        lrCode.clear();
+
+        if (sTermColors == TERM_COLORS_NONE) {
+            continue;
+        }
+
+        if (lAttr == 0) {
+            lrCode = "\033[0m";
+            continue;
+        }
+
+        switch (lBackground) {
+        case 0: lrCode += "\033[40m";  break; // black
+        case 1: lrCode += "\033[44m";  break; // blue
+        case 2: lrCode += "\033[42m";  break; // green
+        case 4: lrCode += "\033[41m";  break; // red
+        case 7: lrCode += "\033[47m";  break; // gray
+        case 8: lrCode += "\033[43m";  break; // yellow
+        default:
+                lrCode += "\033[40m";  break; // black
+        }
+
+        switch (lForeground) 
+        {
+        case 0: lrCode += "\033[30m";  break; // black
+        case 1: lrCode += "\033[34m";  break; // blue
+        case 2: lrCode += "\033[32m";  break; // green
+        case 4: lrCode += "\033[31m";  break; // red
+        case 7: lrCode += "\033[37m";  break; // white
+        default:
+                lrCode += "\033[37m";  break; // white
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::getTermWidth
+//------------------------------------------------------------------------------
+TStringSize SfCTable::getTermWidth( void ) {
+    struct winsize  lWinSize;
+    const SAP_UC*   lpColumns;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &lWinSize) == 0 && lWinSize.ws_col > 0) {
+        return lWinSize.ws_col;
+    }
+
+    lpColumns = getenv("COLUMNS");
+    if (lpColumns != NULL && atoi(lpColumns) > 0) {
+        return atoi(lpColumns);
+    }
+    return 80;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::getInputFd
+//------------------------------------------------------------------------------
+SAP_INT SfCTable::getInputFd( void ) {
+    return STDIN_FILENO;
+}
+
+//------------------------------------------------------------------------------
+// SfCTable::readInput
+// A signal interrupting poll returns as timeout, so the caller sees sAlarmed
+//------------------------------------------------------------------------------
+SAP_INT SfCTable::readInput( const SAP_INT aTimeout ) {
+    SAP_UC          lA7Buffer[256];
+    struct pollfd   lPollFd;
+    ssize_t         lRc;
+
+    if (sInputEof) {
+        return -1;
+    }
+
+    lPollFd.fd      = STDIN_FILENO;
+    lPollFd.events  = POLLIN;
+    lPollFd.revents = 0;
+
+    lRc = poll(&lPollFd, 1, aTimeout);
+    if (lRc <= 0) {
+        return (lRc == 0 || errno == EINTR) ? 0 : -1;
+    }
+
+    lRc = read(STDIN_FILENO, lA7Buffer, sizeof(lA7Buffer));
+    if (lRc < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return 0;
+    }
+
+    if (lRc <= 0) {
+        sInputEof = true;
+        return -1;
+    }
+    sInput.append(lA7Buffer, lRc);
+    return (SAP_INT)lRc;
 }
 
 //------------------------------------------------------------------------------
 // SfCTable::endline
+// The line is composed with its escape sequences and written at once
 //------------------------------------------------------------------------------
 void SfCTable::endline( const EColor aColor ) {
     TString             lOutput = mOutput.str();
+    TString             lLine;
     TString::iterator   lIt;
-    SAP_UINT            lTxtAttr;
 
-    bool                lHandleColour = true;
+    mLinesOut++;
+    mBytesOut += lOutput.size() + 1;
+    SF_STAT(addStat(statsPtr(), STAT_BYTES, lOutput.size() + 1);)
 
     if (spOut != NULL) {
-        fprintf(spOut, "\n%s", mOutput.str().c_str());
+        writeOut(spOut, "\n" + lOutput, statsPtr());
     }
 
-#ifdef SAPwithPASE400
-        lHandleColour = isatty(0) ? true : false;
-#endif
+    //--------------------------------------------------------------------------
+    // Without colors the line is written as it is
+    //--------------------------------------------------------------------------
+    if (getTermColors() == TERM_COLORS_NONE) {
+        lLine.reserve(lOutput.size() + 1);
+        lLine += '\n';
+        lLine += lOutput;
+        writeOut(NULL, std::move(lLine), statsPtr());
+        mOutput.str(cU(""));
 
-    if ((aColor == COLOR_CHAR) && lHandleColour ) {
-        setAttr(0);
-        cout << endl;
-        
+        if (mpRules) {
+            mpRules->mSpans.clear();
+        }
+        return;
+    }
+
+    lLine.reserve(lOutput.size() + 32);
+    appendAttr(lLine, 0);
+    lLine += '\n';
+
+    if (aColor == COLOR_CHAR) {
         for (lIt  = lOutput.begin(); lIt != lOutput.end(); lIt ++) {
             if (*lIt == '*') {
-                cout << "\033[34m";
+                lLine += "\033[34m";
             }
             else if (*lIt == '#') {
-                cout << "\033[37m";
+                lLine += "\033[37m";
             }
             /*SAPUNICODEOK_CHARTYPE*/
-            cout << char(*lIt);
+            lLine += char(*lIt);
         }
     }
     else {
-        setAttr(0);
-        cout << endl;
-        setColor(aColor);
-        cout << mOutput.str();
+        SAP_UINT    lAttr = evalColor(aColor);
+        size_t      lPos  = 0;
+
+        if (aColor != COLOR_NONE) {
+            appendAttr(lLine, lAttr);
+        }
+
+        //----------------------------------------------------------------------
+        // Cells colored by rules switch the color and back
+        //----------------------------------------------------------------------
+        if (mpRules) {
+            for (size_t iSpan = 0; iSpan < mpRules->mSpans.size(); iSpan++) {
+                size_t      lEnd   = MIN(mpRules->mSpans[iSpan].first, lOutput.size());
+                SAP_UINT    lColor = mpRules->mSpans[iSpan].second;
+
+                lLine.append(lOutput, lPos, lEnd - lPos);
+                lPos = lEnd;
+
+                if (lColor != 0) {
+                    appendCellColor(lLine, lColor);
+                }
+                else {
+                    appendAttr(lLine, aColor != COLOR_NONE ? lAttr : 0);
+                }
+            }
+        }
+        lLine.append(lOutput, lPos, TString::npos);
+    }
+
+    if (mpRules) {
+        mpRules->mSpans.clear();
     }
-    cout.flush();
+    SF_STAT(addStat(statsPtr(), STAT_ESCAPE_BYTES, lLine.size() - lOutput.size() - 1);)
+    writeOut(NULL, std::move(lLine), statsPtr());
     mOutput.str(cU(""));
 }
 
@@ -0,0 +1,403 @@
+// -----------------------------------------------------------------
+//
+// Author: Albert Zedlitz
+// File  : sfxxao.hpp
+// Date  : 11.08.2017
+// Abstract:
+//    Ascii Table
+//    Asynchronous output
+//
+// Copyright (C) 2017  Albert Zedlitz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// -----------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include <cstddef>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <utility>
+
+//==============================================================================
+/// @class SfCAsyncOut
+/// Writer thread for rendered output lines.
+/// Producers hand complete lines over through a bounded lock-free queue
+/// (D. Vyukov's bounded MPMC ring), the writer thread does the I/O. So a slow
+/// terminal or a stalled pipe never blocks the rendering thread, unless the
+/// policy QUEUE_BLOCK says so.
+//==============================================================================
+class SfCAsyncOut
+{
+public:
+    //--------------------------------------------------------------------------
+    /// @enum EPolicy
+    /// Behavior of a producer if the queue is full.
+    //--------------------------------------------------------------------------
+    typedef enum EPolicy {
+        QUEUE_BLOCK,           ///< wait for the writer
+        QUEUE_DROP_OLDEST,     ///< discard the oldest queued line
+        QUEUE_COALESCE         ///< collect lines and queue them as one block
+    } EPolicy;
+
+private:
+    //--------------------------------------------------------------------------
+    /// @struct TSlot
+    /// Queue slot. The sequence number tells whether the slot is free for
+    /// the producer at position mSeq or filled for the consumer at mSeq - 1.
+    //--------------------------------------------------------------------------
+    typedef struct TSlot {
+        std::atomic<size_t> mSeq;       ///< slot sequence number
+        FILE*               mpFile;     ///< target file, NULL: terminal
+        TString             mData;      ///< rendered output
+    } TSlot;
+
+    std::unique_ptr<TSlot[]>    mpSlots;    ///< ring buffer
+    size_t                      mMask;      ///< capacity - 1
+    std::atomic<size_t>         mHead;      ///< next enqueue position
+    std::atomic<size_t>         mTail;      ///< next dequeue position
+    EPolicy                     mPolicy;    ///< full queue policy
+
+    std::atomic<SAP_ULLONG>     mPushed;    ///< lines queued
+    std::atomic<SAP_ULLONG>     mDone;      ///< lines written or dropped
+    std::atomic<SAP_ULLONG>     mDropped;   ///< lines dropped
+    std::atomic<bool>           mStop;      ///< writer shall terminate
+    std::atomic<bool>           mIdle;      ///< writer sleeps on mCondData
+    std::atomic<size_t>         mWaiters;   ///< producers sleeping on mCondSpace
+
+    std::mutex                  mMutex;     ///< for sleeping only
+    std::condition_variable     mCondData;  ///< data available
+    std::condition_variable     mCondSpace; ///< space or idle
+    std::thread                 mWriter;    ///< writer thread
+
+    //--------------------------------------------------------------------------
+    /// Lines collected by this producer thread under QUEUE_COALESCE.
+    //--------------------------------------------------------------------------
+    static TString& overflow(void) {
+        static thread_local TString sOverflow;
+        return sOverflow;
+    }
+
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor. Starts the writer thread.
+    //--------------------------------------------------------------------------
+    SfCAsyncOut(
+        size_t      aCapacity,              ///< queue capacity in lines
+        EPolicy     aPolicy = QUEUE_BLOCK): ///< full queue policy
+        mMask(0),
+        mHead(0),
+        mTail(0),
+        mPolicy(aPolicy),
+        mPushed(0),
+        mDone(0),
+        mDropped(0),
+        mStop(false),
+        mIdle(false),
+        mWaiters(0) {
+
+        size_t lCapacity = 2;
+
+        while (lCapacity < aCapacity) {
+            lCapacity <<= 1;
+        }
+        mMask = lCapacity - 1;
+        mpSlots.reset(new TSlot[lCapacity]);
+
+        for (size_t i = 0; i < lCapacity; i++) {
+            mpSlots[i].mSeq.store(i, std::memory_order_relaxed);
+            mpSlots[i].mpFile = NULL;
+        }
+        mWriter = std::thread(&SfCAsyncOut::run, this);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Destructor. Writes all queued lines and stops the writer thread.
+    //--------------------------------------------------------------------------
+    ~SfCAsyncOut() {
+        wait();
+        mStop = true;
+        {
+            std::lock_guard<std::mutex> lLock(mMutex);
+        }
+        mCondData.notify_one();
+        mWriter.join();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Queues a line for the writer thread.
+    //--------------------------------------------------------------------------
+    void push(
+        FILE*       apFile,                 ///< target file, NULL: terminal
+        TString&&   arData ) {              ///< rendered output
+        TString&    lrOverflow = overflow();
+
+        if (mPolicy == QUEUE_COALESCE) {
+            //------------------------------------------------------------------
+            // Earlier lines of this thread wait in the overflow block, keep
+            // the order and queue them first.
+            //------------------------------------------------------------------
+            if (!lrOverflow.empty()) {
+                if (apFile == NULL) {
+                    lrOverflow.append(arData);
+                    if (tryPush(NULL, std::move(lrOverflow))) {
+                        lrOverflow.clear();
+                    }
+                    return;
+                }
+                pushWait(NULL, std::move(lrOverflow));
+                lrOverflow.clear();
+            }
+
+            if (!tryPush(apFile, std::move(arData))) {
+                if (apFile == NULL) {
+                    lrOverflow = std::move(arData);
+                }
+                else {
+                    pushWait(apFile, std::move(arData));
+                }
+            }
+            return;
+        }
+
+        if (mPolicy == QUEUE_DROP_OLDEST) {
+            FILE*    lpFile;
+            TString  lData;
+
+            while (!tryPush(apFile, std::move(arData))) {
+                if (tryPop(lpFile, lData)) {
+                    mDropped++;
+                    mDone++;
+                    wakeProducers();
+                }
+            }
+            return;
+        }
+        pushWait(apFile, std::move(arData));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Waits until all lines queued so far are written.
+    //--------------------------------------------------------------------------
+    void wait(void) {
+        SAP_ULLONG  lTarget = mPushed.load();
+
+        sleep([this, lTarget] { return mDone.load() >= lTarget; });
+    }
+
+    //--------------------------------------------------------------------------
+    /// Queues the lines collected by this thread and waits until all lines
+    /// are written.
+    //--------------------------------------------------------------------------
+    void flush(void) {
+        TString& lrOverflow = overflow();
+
+        if (!lrOverflow.empty()) {
+            pushWait(NULL, std::move(lrOverflow));
+            lrOverflow.clear();
+        }
+        wait();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Number of lines dropped by QUEUE_DROP_OLDEST.
+    //--------------------------------------------------------------------------
+    SAP_ULLONG getDropped(void) const {
+        return mDropped.load();
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Enqueues without waiting.
+    /// @retval false   the queue is full.
+    //--------------------------------------------------------------------------
+    bool tryPush(
+        FILE*       apFile,                 ///< target file
+        TString&&   arData ) {              ///< rendered output
+        TSlot*  lpSlot;
+        size_t  lPos = mHead.load(std::memory_order_relaxed);
+
+        for (;;) {
+            lpSlot = &mpSlots[lPos & mMask];
+
+            size_t    lSeq = lpSlot->mSeq.load(std::memory_order_acquire);
+            ptrdiff_t lDif = (ptrdiff_t)lSeq - (ptrdiff_t)lPos;
+
+            if (lDif == 0) {
+                if (mHead.compare_exchange_weak(lPos, lPos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lDif < 0) {
+                return false;
+            }
+            else {
+                lPos = mHead.load(std::memory_order_relaxed);
+            }
+        }
+
+        lpSlot->mpFile = apFile;
+        lpSlot->mData  = std::move(arData);
+        mPushed++;
+        lpSlot->mSeq.store(lPos + 1, std::memory_order_release);
+
+        //----------------------------------------------------------------------
+        // The fence pairs with the one in run(): either the writer sees the
+        // line before it sleeps, or this thread sees it sleeping.
+        //----------------------------------------------------------------------
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (mIdle.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lLock(mMutex);
+
+            mCondData.notify_one();
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Enqueues and waits for space if necessary.
+    //--------------------------------------------------------------------------
+    void pushWait(
+        FILE*       apFile,                 ///< target file
+        TString&&   arData ) {              ///< rendered output
+        while (!tryPush(apFile, std::move(arData))) {
+            sleep([this] { return !full(); });
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Sleeps until the writer made the condition true.
+    //--------------------------------------------------------------------------
+    template<typename TPred>
+    void sleep( TPred aReady ) {            ///< condition to wait for
+        std::unique_lock<std::mutex> lLock(mMutex);
+
+        mWaiters++;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        mCondSpace.wait(lLock, aReady);
+        mWaiters--;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Wakes sleeping producers after a line was written or dropped.
+    //--------------------------------------------------------------------------
+    void wakeProducers(void) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (mWaiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lLock(mMutex);
+
+            mCondSpace.notify_all();
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// The slot at the enqueue position is not yet free.
+    //--------------------------------------------------------------------------
+    bool full(void) const {
+        size_t  lPos = mHead.load(std::memory_order_relaxed);
+
+        return (ptrdiff_t)mpSlots[lPos & mMask].mSeq.load(std::memory_order_acquire) - (ptrdiff_t)lPos < 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// The slot at the dequeue position is not yet filled.
+    //--------------------------------------------------------------------------
+    bool empty(void) const {
+        size_t  lPos = mTail.load(std::memory_order_relaxed);
+
+        return (ptrdiff_t)mpSlots[lPos & mMask].mSeq.load(std::memory_order_acquire) - (ptrdiff_t)(lPos + 1) < 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Dequeues without waiting.
+    /// @retval false   the queue is empty.
+    //--------------------------------------------------------------------------
+    bool tryPop(
+        FILE*&      arpFile,                ///< target file
+        TString&    arData ) {              ///< rendered output
+        TSlot*  lpSlot;
+        size_t  lPos = mTail.load(std::memory_order_relaxed);
+
+        for (;;) {
+            lpSlot = &mpSlots[lPos & mMask];
+
+            size_t    lSeq = lpSlot->mSeq.load(std::memory_order_acquire);
+            ptrdiff_t lDif = (ptrdiff_t)lSeq - (ptrdiff_t)(lPos + 1);
+
+            if (lDif == 0) {
+                if (mTail.compare_exchange_weak(lPos, lPos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (lDif < 0) {
+                return false;
+            }
+            else {
+                lPos = mTail.load(std::memory_order_relaxed);
+            }
+        }
+
+        arpFile = lpSlot->mpFile;
+        arData  = std::move(lpSlot->mData);
+        lpSlot->mSeq.store(lPos + mMask + 1, std::memory_order_release);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Writer thread. Files are flushed whenever the queue runs empty.
+    //--------------------------------------------------------------------------
+    void run(void) {
+        FILE*    lpFile;
+        FILE*    lpLast = NULL;
+        TString  lData;
+
+        for (;;) {
+            if (tryPop(lpFile, lData)) {
+                lpFile = (lpFile != NULL) ? lpFile : stdout;
+                fwrite(lData.data(), 1, lData.size(), lpFile);
+
+                if (lpLast != NULL && lpLast != lpFile) {
+                    fflush(lpLast);
+                }
+                lpLast = lpFile;
+                mDone++;
+                wakeProducers();
+                continue;
+            }
+
+            if (lpLast != NULL) {
+                fflush(lpLast);
+                lpLast = NULL;
+            }
+
+            if (mStop.load()) {
+                break;
+            }
+
+            std::unique_lock<std::mutex> lLock(mMutex);
+
+            mIdle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            mCondData.wait(lLock, [this] { return mStop.load() || !empty(); });
+            mIdle.store(false, std::memory_order_relaxed);
+        }
+    }
+};
@@ -30,7 +30,35 @@
 
 #include <iostream>
 #include <deque>
+#include <vector>
 #include <iomanip>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <cassert>
+#include <chrono>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include <regex>
+
+#include "sfxxuc.hpp"
+#include "sfxxao.hpp"
+#ifdef SF_ZLIB
+#include "sfxxzo.hpp"
+#endif
+
+//------------------------------------------------------------------------------
+// Rendering statistics are compiled in with SF_TABLE_STATS. Without it the
+// counters and timers are not part of the code.
+//------------------------------------------------------------------------------
+#ifdef SF_TABLE_STATS
+#   define SF_STAT(...)     __VA_ARGS__
+#else
+#   define SF_STAT(...)
+#endif
 
 //==============================================================================
 /// @class SfCTable
@@ -46,19 +74,31 @@ private:
     static SAP_CUINT    sMaxRowWidth;    ///< Maximum row with
     static SAP_CUINT    sMaxColWidth;    ///< Maximum column width
     static SAP_CUINT    sMinColWidth;    ///< Minimum column width
-    static SAP_CUINT    sMaxColCount;    ///< Maximum column count
-    static SAP_UINT     sPageLength;     ///< Maximum table length
+    static SAP_UINT     sMaxColCount;    ///< Default maximum column count
+    static SAP_UINT     sPageLength;     ///< Default maximum table length
     static SAP_INT      sTableLength;    ///< Maximum rows number in print
     static bool         sAlarmed;        ///< SIGALRM caught?
+    static SfCAsyncOut* spAsync;         ///< Writer thread, NULL: synchronous
+#ifdef SF_ZLIB
+    static SfCZipOut*   spZip;           ///< Compressor of the redirected output
+#endif
+    static TString      sInput;          ///< Terminal input not yet returned
+    static bool         sInputEof;       ///< Terminal input closed
+    static SAP_UINT     sTermColors;     ///< Colors of the terminal, see ETermColors
+    static bool         sTermColorsSet;  ///< Colors are detected or set
+    static TString      sPalette[256];   ///< Escape sequences per attribute
 public:
 
     static TString      sSepStr;         ///< Dynamic column separator char
 
 #   define MIN_COL_WIDTH    3
 #   define MAX_COL_WIDTH    2048
-#   define MAX_COL_COUNT    32
+#   define MAX_COL_COUNT    0            // no limit
 #   define MAX_ROW_WIDTH    4096
 #   define MAX_ROW_COUNT    10000
+#   define DICT_NONE        0xFFFFFFFF
+#   define CELL_ATTR        0x1000000    // cell color is a console attribute
+#   define CELL_RGB         0x2000000    // cell color is a 24 bit background
 
     //--------------------------------------------------------------------------
     /// @enum EColor
@@ -89,6 +129,65 @@ public:
         PRINT_BODY             ///< print body without header
     } EPrintOption;
 
+    //--------------------------------------------------------------------------
+    /// @enum EBudget
+    /// What a table does when its rows exceed the byte budget.
+    //--------------------------------------------------------------------------
+    typedef enum EBudget {
+        BUDGET_FLUSH,          ///< print and release the page early
+        BUDGET_SPILL,          ///< move the page to a temporary file
+        BUDGET_TRUNCATE,       ///< cut the values of new cells, then drop
+        BUDGET_REJECT          ///< drop new rows and cells
+    } EBudget;
+
+    //--------------------------------------------------------------------------
+    /// @enum EBorder
+    /// Characters of the separator lines and the column separators.
+    //--------------------------------------------------------------------------
+    typedef enum EBorder {
+        BORDER_ASCII,          ///< +---+ lines and sSepStr, the default
+        BORDER_BOX,            ///< Unicode box drawing, closed by a bottom line
+        BORDER_MINIMAL,        ///< a dashed line below the header, no columns
+        BORDER_NONE,           ///< no lines, columns separated by a blank
+        BORDER_COUNT
+    } EBorder;
+
+    //--------------------------------------------------------------------------
+    /// @enum ETermColors
+    /// Colors supported by the terminal.
+    //--------------------------------------------------------------------------
+    typedef enum ETermColors {
+        TERM_COLORS_NONE = 0,           ///< no colors, output without escapes
+        TERM_COLORS_8    = 8,           ///< basic ANSI or console colors
+        TERM_COLORS_256  = 256,         ///< xterm 256 color palette
+        TERM_COLORS_TRUE = 0x1000000    ///< 24 bit colors
+    } ETermColors;
+
+    //--------------------------------------------------------------------------
+    /// @typedef TExpand
+    /// Callback that fills a lazy subtable when it is expanded and printed.
+    //--------------------------------------------------------------------------
+    typedef std::function<void(SfCTable&)> TExpand;
+
+    //--------------------------------------------------------------------------
+    /// @enum EStat
+    /// Counters of the rendering statistics, see TStats.
+    //--------------------------------------------------------------------------
+    typedef enum EStat {
+        STAT_ROWS,              ///< Rows added
+        STAT_CELLS,             ///< Cells added
+        STAT_BYTES,             ///< Text bytes rendered
+        STAT_ESCAPE_BYTES,      ///< Bytes of color escape sequences
+        STAT_WRITES,            ///< Write calls
+        STAT_FLUSHES,           ///< Page flushes in row()
+        STAT_PEAK_ROW_BYTES,    ///< Peak memory of the rows
+        STAT_NS_INGEST,         ///< Nanoseconds adding cells
+        STAT_NS_WIDTH,          ///< Nanoseconds evaluating the layout
+        STAT_NS_RENDER,         ///< Nanoseconds printing, including I/O
+        STAT_NS_IO,             ///< Nanoseconds writing
+        STAT_COUNT
+    } EStat;
+
     //--------------------------------------------------------------------------
     /// @enum EFlags
     /// Flags for row and column layout.
@@ -109,7 +208,10 @@ public:
         R_SUBTABLE,            ///< Row starts a subtable
         R_PROMPT,              ///< Row prompt and read input
         R_ACKNOWLEDGE,         ///< Row prompt and read acknowledge
-        R_MESSAGE              ///< Row with result, warning or error
+        R_MESSAGE,             ///< Row with result, warning or error
+        DICT,                  ///< Column values are stored as dictionary codes
+        WRAP,                  ///< Column values wrap at the column width
+        HIGHLIGHT              ///< Cell color is shown as cell background
     } EFlags;
 
     //==========================================================================
@@ -146,23 +248,14 @@ public:
         }
 
         //----------------------------------------------------------------------
-        /// Copy constructor.
-        //----------------------------------------------------------------------
-        TAttr( const TAttr& arAttr ):               ///< the attributes to copy.
-              mFlags(arAttr.mFlags),
-              mColor(arAttr.mColor),
-              mWidth(arAttr.mWidth) {
-        }
-
-        //----------------------------------------------------------------------
-        /// Assignment operator.
+        /// Copy and move operations.
+        /// The attributes are plain values, the defaults keep the class
+        /// trivially copyable, so that passing them around is a register copy.
         //----------------------------------------------------------------------
-        TAttr& operator = ( const TAttr& arAttr ) { ///< the attributes to copy.
-            mFlags = arAttr.mFlags;
-            mColor = arAttr.mColor;
-            mWidth = arAttr.mWidth;
-            return *this;
-        }
+        TAttr( const TAttr& arAttr ) = default;
+        TAttr( TAttr&& arAttr ) = default;
+        TAttr& operator = ( const TAttr& arAttr ) = default;
+        TAttr& operator = ( TAttr&& arAttr ) = default;
 
         //----------------------------------------------------------------------
         /// Sets a flag.
@@ -266,20 +359,85 @@ public:
         }
     };
 
+public:
+    //==========================================================================
+    /// @class TRef
+    /// Borrowed cell value.
+    /// The table keeps only pointer and length and renders directly from the
+    /// caller's buffer. The buffer must stay alive and unchanged until the
+    /// table is destroyed, or until the row was flushed by the page overflow.
+    /// Debug builds verify the contract with a checksum at render time.
+    //==========================================================================
+    class TRef {
+    public:
+        const SAP_UC*   mpData;     ///< caller owned text
+        TStringSize     mLen;       ///< text length in bytes
+
+        //----------------------------------------------------------------------
+        /// Constructor for a zero terminated string. NULL is an empty value.
+        //----------------------------------------------------------------------
+        TRef( const SAP_UC* apData ):       ///< caller owned text
+            mpData(apData ? apData : ""),
+            mLen(apData ? strlen(apData) : 0) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Constructor for a buffer with length.
+        //----------------------------------------------------------------------
+        TRef(
+            const SAP_UC*   apData,         ///< caller owned text
+            TStringSize     aLen ):         ///< text length in bytes
+            mpData(apData),
+            mLen(aLen) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Constructor for a long-lived string. Temporaries are rejected.
+        //----------------------------------------------------------------------
+        TRef( const TString& arData ):      ///< caller owned text
+            mpData(arData.data()),
+            mLen(arData.size()) {
+        }
+
+        TRef( TString&& ) = delete;
+    };
+
 private:
     //==========================================================================
     /// @class TCell
     /// The cell class manages the cells of a table. It provides the cell
     /// width and type, which allows to compute the maximum width for formatted
-    /// output.
+    /// output. The value is either owned by the cell or borrowed from the
+    /// caller (see TRef). A borrowed value is stored in place of the own
+    /// string, so it does not make the cell larger.
     //==========================================================================
     class TCell {
         friend class    SfCTable;
 
     private:
-        TString        mValue;      ///< cell value
+        //----------------------------------------------------------------------
+        /// @struct TBorrowed
+        /// Pointer and length of a borrowed value.
+        //----------------------------------------------------------------------
+        typedef struct TBorrowed {
+            const SAP_UC*   mpData;     ///< caller owned text
+            TStringSize     mLen;       ///< text length in bytes
+#ifndef NDEBUG
+            SAP_ULLONG      mHash;      ///< checksum of the borrowed value
+#endif
+        } TBorrowed;
+
+        union {
+            TString    mValue;      ///< own cell value, unless mBorrowed
+            TBorrowed  mRef;        ///< borrowed value, if mBorrowed
+        };
         TAttr          mCellAttr;   ///< cell attributes
-        TString        mRemain;     ///< remainder for line break
+        TStringSize    mRemain;     ///< offset of the remainder for line break
+        TStringSize    mDispWidth;  ///< display width of the widest line
+        bool           mAscii;      ///< value is pure ASCII
+        bool           mBreak;      ///< value contains line breaks
+        bool           mBorrowed;   ///< the value is borrowed
+        SAP_UINT       mCode;       ///< dictionary code or DICT_NONE
 
     public:
         //----------------------------------------------------------------------
@@ -287,15 +445,50 @@ private:
         //----------------------------------------------------------------------
         TCell(): 
             mValue(""),
-            mCellAttr(TAttr()) {
+            mCellAttr(TAttr()),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(false),
+            mCode(DICT_NONE) {
         }
 
         //----------------------------------------------------------------------
         /// Copy constructor.
         //----------------------------------------------------------------------
         TCell( const TCell& arCell ):        ///< the cell to copy.
-            mValue(arCell.mValue),
             mCellAttr(arCell.mCellAttr) {
+            if (arCell.mBorrowed) {
+                new (&mRef) TBorrowed(arCell.mRef);
+            }
+            else {
+                new (&mValue) TString(arCell.mValue);
+            }
+            copyState(arCell);
+        }
+
+        //----------------------------------------------------------------------
+        /// Move constructor.
+        //----------------------------------------------------------------------
+        TCell( TCell&& arCell ) noexcept:    ///< the cell to move.
+            mCellAttr(arCell.mCellAttr) {
+            if (arCell.mBorrowed) {
+                new (&mRef) TBorrowed(arCell.mRef);
+            }
+            else {
+                new (&mValue) TString(std::move(arCell.mValue));
+            }
+            copyState(arCell);
+        }
+
+        //----------------------------------------------------------------------
+        /// Destructor.
+        //----------------------------------------------------------------------
+        ~TCell() {
+            if (!mBorrowed) {
+                mValue.~TString();
+            }
         }
 
         //----------------------------------------------------------------------
@@ -304,7 +497,29 @@ private:
             const TString&  arValue,
             const TAttr&    arAttr ): 
             mValue(arValue),
-            mCellAttr(arAttr) {
+            mCellAttr(arAttr),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(false),
+            mCode(DICT_NONE) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Takes over the value without copying.
+        //----------------------------------------------------------------------
+        TCell(
+            TString&&       arValue,
+            const TAttr&    arAttr ): 
+            mValue(std::move(arValue)),
+            mCellAttr(arAttr),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(false),
+            mCode(DICT_NONE) {
         }
 
         //----------------------------------------------------------------------
@@ -313,18 +528,159 @@ private:
             const SAP_UC*   apValue,
             const TAttr&    arAttr ):
             mValue(apValue),
-            mCellAttr(arAttr) {
+            mCellAttr(arAttr),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(false),
+            mCode(DICT_NONE) {
+        }
+
+#ifdef SF_STRING_VIEW
+        //----------------------------------------------------------------------
+        //----------------------------------------------------------------------
+        TCell(
+            TStringView     aValue,
+            const TAttr&    arAttr ):
+            mValue(aValue),
+            mCellAttr(arAttr),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(false),
+            mCode(DICT_NONE) {
+        }
+#endif
+
+        //----------------------------------------------------------------------
+        /// Borrows the value from the caller.
+        //----------------------------------------------------------------------
+        TCell(
+            const TRef&     arRef,
+            const TAttr&    arAttr ):
+            mRef(),
+            mCellAttr(arAttr),
+            mRemain(0),
+            mDispWidth(0),
+            mAscii(true),
+            mBreak(false),
+            mBorrowed(true),
+            mCode(DICT_NONE) {
+            borrow(arRef.mpData, arRef.mLen);
         }
 
         //----------------------------------------------------------------------
         /// Assignment operator.
         //----------------------------------------------------------------------
         TCell& operator=( const TCell& arCell ) {        ///< the cell to copy.
-            mValue = arCell.mValue;
+            if (arCell.mBorrowed) {
+                borrow(arCell.mRef.mpData, arCell.mRef.mLen);
+            }
+            else if (this != &arCell) {
+                own() = arCell.mValue;
+            }
+            mCellAttr = arCell.mCellAttr;
+            copyState(arCell);
+            return *this;
+        }
+
+        //----------------------------------------------------------------------
+        /// Move assignment operator.
+        //----------------------------------------------------------------------
+        TCell& operator=( TCell&& arCell ) noexcept {    ///< the cell to move.
+            if (arCell.mBorrowed) {
+                borrow(arCell.mRef.mpData, arCell.mRef.mLen);
+            }
+            else {
+                own() = std::move(arCell.mValue);
+            }
             mCellAttr = arCell.mCellAttr;
+            copyState(arCell);
             return *this;
         }
 
+        //----------------------------------------------------------------------
+        /// The cell's value, owned or borrowed.
+        //----------------------------------------------------------------------
+        const SAP_UC* data() const {
+            return mBorrowed ? mRef.mpData : mValue.data();
+        }
+
+        //----------------------------------------------------------------------
+        /// Length of the cell's value in bytes.
+        //----------------------------------------------------------------------
+        TStringSize size() const {
+            return mBorrowed ? mRef.mLen : mValue.size();
+        }
+
+        //----------------------------------------------------------------------
+        /// Replaces the value by a borrowed one.
+        //----------------------------------------------------------------------
+        void borrow(
+            const SAP_UC*   apData,         ///< caller owned text
+            TStringSize     aLen ) {        ///< text length in bytes
+            if (!mBorrowed) {
+                mValue.~TString();
+                mBorrowed = true;
+            }
+            mRef.mpData = apData;
+            mRef.mLen   = aLen;
+#ifndef NDEBUG
+            mRef.mHash  = checksum();
+#endif
+        }
+
+        //----------------------------------------------------------------------
+        /// The own value, a borrowed value is replaced by an empty one.
+        //----------------------------------------------------------------------
+        TString& own() {
+            if (mBorrowed) {
+                new (&mValue) TString();
+                mBorrowed = false;
+            }
+            return mValue;
+        }
+
+        //----------------------------------------------------------------------
+        /// Caches the display width of a value that is known to be ASCII
+        /// without line breaks, e.g. a formatted number.
+        //----------------------------------------------------------------------
+        void measureAscii() {
+            mAscii     = true;
+            mBreak     = false;
+            mDispWidth = size();
+        }
+
+        //----------------------------------------------------------------------
+        /// Computes and caches the display width of the value.
+        /// For values with line breaks this is the width of the widest line.
+        //----------------------------------------------------------------------
+        void measure() {
+            const SAP_UC*  lpData = data();
+            TStringSize    lSize  = size();
+            TStringSize    lPos   = 0;
+            TStringSize    lOff   = 0;
+
+            mAscii     = SfCUtf8::isAscii(lpData, lSize);
+            mBreak     = false;
+            mDispWidth = 0;
+
+            do {
+                const void* lpEol = memchr(lpData + lOff, '\n', lSize - lOff);
+
+                lPos    = lpEol ? (TStringSize)((const SAP_UC*)lpEol - lpData) : lSize;
+                mBreak |= (lpEol != NULL);
+
+                TStringSize lWidth = mAscii ? (lPos - lOff) : SfCUtf8::width(lpData + lOff, lPos - lOff);
+                if (mDispWidth < lWidth) {
+                    mDispWidth = lWidth;
+                }
+                lOff = lPos + 1;
+            } while (lOff < lSize);
+        }
+
         //----------------------------------------------------------------------
         /// Get the cell's value as text.
         /// The result can be
@@ -332,801 +688,4919 @@ private:
         ///    cell's attributes), or
         ///  -    a part of the value (if the value contains newline characters or
         ///    if it doesn't fit into the available space).
+        /// The result points into the cell's value and is not terminated.
         //----------------------------------------------------------------------
-        TString getValue(
-                const bool  aContinue,      ///< Continuation call
-                bool&        arRemain) {    ///< tells whether some data remains.
-
-            TString        lValue;
-            TStringSize    lOff = 0;
+        const SAP_UC* getValue(
+                const bool    aContinue,    ///< Continuation call
+                bool&         arRemain,     ///< tells whether some data remains.
+                TStringSize&  arWidth,      ///< display width of the result
+                TStringSize&  arLen,        ///< length of the result in bytes
+                TStringSize   aWrap = 0) {  ///< wrap width of the column, 0: none
+
+            const SAP_UC*  lpValue = data();
+            TStringSize    lSize   = size();
+            TStringSize    lOff    = 0;
             TStringSize    lPos;
+            TStringSize    lLimit  = mCellAttr.test(FIXED) ? mCellAttr.mWidth : aWrap;
 
+#ifndef NDEBUG
+            assert((!mBorrowed || mRef.mHash == checksum()) &&
+                   "SfCTable::TRef: borrowed buffer changed or released before print");
+#endif
             if (!aContinue) {
-                mRemain = mValue;
+                if (!mBreak && !((lLimit > 0) && (lLimit < mDispWidth))) {
+                    //----------------------------------------------------------
+                    // Single line that fits: use the cached width.
+                    //----------------------------------------------------------
+                    mRemain  = lSize;
+                    arRemain = false;
+                    arWidth  = mDispWidth;
+                    arLen    = lSize;
+                    return lpValue;
+                }
+                mRemain = 0;
             }
 
-            lPos = mRemain.find_first_of("\n");
-            if (lPos == TString::npos) {
-                lPos = mRemain.size();
-            }
-            else if ((lPos > 0) && (mRemain.at(lPos - 1) == ('\r'))) {
-                lPos--;
-                lOff = 2;
+            lpValue += mRemain;
+            lSize   -= mRemain;
+
+            const void* lpEol = memchr(lpValue, '\n', lSize);
+
+            if (lpEol == NULL) {
+                lPos = lSize;
             }
             else {
-                lOff = 1;
+                lPos = (const SAP_UC*)lpEol - lpValue;
+                if ((lPos > 0) && (lpValue[lPos - 1] == '\r')) {
+                    lPos--;
+                    lOff = 2;
+                }
+                else {
+                    lOff = 1;
+                }
             }
 
-            if (mCellAttr.test(FIXED) && (mCellAttr.mWidth < lPos)) {
-                lPos = mCellAttr.mWidth;
+            arWidth = mAscii ? lPos : SfCUtf8::width(lpValue, lPos);
+
+            if ((lLimit > 0) && (lLimit < arWidth)) {
+                //--------------------------------------------------------------
+                // Wrap at a character boundary, the rest continues in the next
+                // output line.
+                //--------------------------------------------------------------
+                lPos = SfCUtf8::cut(lpValue, lPos, lLimit, arWidth);
+                lOff = 0;
             }
 
-            lValue = mRemain.substr(0, lPos);
-            mRemain = mRemain.substr(lPos + lOff);
+            mRemain += lPos + lOff;
 
-            arRemain = (mRemain.size() > 0);
-            return lValue;
+            arRemain = (mRemain < size());
+            arLen    = lPos;
+            return lpValue;
         }
-    };
 
-    //==========================================================================
-    /// @typedef TCells
-    /// Container for the cells of a row.
-    //==========================================================================
-    typedef deque<TCell> TCells;
+    private:
+        //----------------------------------------------------------------------
+        /// Copies everything but value and attributes.
+        //----------------------------------------------------------------------
+        void copyState( const TCell& arCell ) {     ///< the source cell
+            mRemain    = arCell.mRemain;
+            mDispWidth = arCell.mDispWidth;
+            mAscii     = arCell.mAscii;
+            mBreak     = arCell.mBreak;
+            mBorrowed  = arCell.mBorrowed;
+            mCode      = arCell.mCode;
+        }
+
+#ifndef NDEBUG
+        //----------------------------------------------------------------------
+        /// FNV-1a checksum of the borrowed value.
+        //----------------------------------------------------------------------
+        SAP_ULLONG checksum() const {
+            SAP_ULLONG  lHash = 14695981039346656037ULL;
+
+            for (TStringSize i = 0; i < mRef.mLen; i++) {
+                lHash = (lHash ^ (unsigned char)mRef.mpData[i]) * 1099511628211ULL;
+            }
+            return lHash;
+        }
+#endif
+    };
 
     //==========================================================================
-    /// @class TRow
-    /// The row class stores the cells of each row.
-    /// A row can contain header cells or data cells, and it may contain input
-    /// from the terminal.
+    /// @class TDict
+    /// Dictionary of one DICT column.
+    /// Each distinct value is stored and measured once as a cell, the rows
+    /// keep only its code. A value with other cell flags or another color,
+    /// e.g. a number, gets an entry of its own. An entry counts the codes
+    /// in the rows and is released with the last one. For output the entries
+    /// are padded once for the column width and copied as a whole.
     //==========================================================================
-    class TRow {
+    class TDict {
         friend class    SfCTable;
 
     private:
-        SfCTable*    mpSubTable;    ///< Subtable
-        TRow*        mpHeader;      ///< Header row
-        TCells       mCells;        ///< Cells within the row
-        TAttr        mRowAttr;      ///< Row layout flags
-        bool         mContinue;     ///< Linebreak in a column
+        //----------------------------------------------------------------------
+        /// @struct TEntry
+        /// Distinct value with its cached layout.
+        //----------------------------------------------------------------------
+        typedef struct TEntry {
+            TCell           mCell;      ///< the value, borrowed from the index
+            SAP_UINT        mRefs;      ///< codes of the entry in the rows
+            TString         mPadded;    ///< value padded to mPadWidth
+            TStringSize     mPadWidth;  ///< width of mPadded
+            bool            mPadRight;  ///< mPadded is right aligned
+        } TEntry;
+
+        unordered_map<TString, SAP_UINT>    mIndex;     ///< value and attributes to code
+        deque<TEntry>                       mEntries;   ///< code to entry
+        vector<SAP_UINT>                    mFree;      ///< codes of released entries
+        TString                             mKey;       ///< lookup key, reused
 
-    public:
         //----------------------------------------------------------------------
-        /// Default constructor.
+        /// Builds the index key of a cell: the value, the flags and the color.
         //----------------------------------------------------------------------
-        TRow() :
-            mpSubTable(NULL),
-            mpHeader(NULL),
-            mContinue(false) {
+        const TString& key( const TCell& arCell ) { ///< the cell
+            const SAP_UINT  lAttr[2] = { arCell.mCellAttr.mFlags, (SAP_UINT)arCell.mCellAttr.mColor };
+
+            mKey.assign(arCell.data(), arCell.size());
+            mKey.append((const SAP_UC*)lAttr, sizeof(lAttr));
+            return mKey;
         }
 
         //----------------------------------------------------------------------
-        /// Destructor.
+        /// Memory of an entry with its index node.
         //----------------------------------------------------------------------
-        ~TRow() {
-            if (mpSubTable) {
-                delete mpSubTable;
-            }
+        static SAP_ULLONG entryBytes( const TString& arKey ) {  ///< Index key
+            static const size_t lInline = TString().capacity();
+            SAP_ULLONG  lBytes = sizeof(TEntry) + sizeof(std::pair<const TString, SAP_UINT>) + 2 * sizeof(void*);
+
+            return (arKey.capacity() > lInline) ? lBytes + arKey.capacity() + 1 : lBytes;
         }
-    };
 
-    //==========================================================================
-    /// Container for the rows of a terminal table.
-    /// The first row in mRows is the header row, other rows contain data or
-    /// act as placeholders for sub-tables.
-    //==========================================================================
-    typedef deque<TRow>    TRows;
+    public:
+        //----------------------------------------------------------------------
+        /// Interns the cell's value and makes the cell a copy of the entry,
+        /// with its code.
+        /// @return Memory of a new entry, 0 if the value is known
+        //----------------------------------------------------------------------
+        SAP_ULLONG intern( TCell& arCell ) {    ///< the new cell
+            unordered_map<TString, SAP_UINT>::iterator lIt = mIndex.find(key(arCell));
+            SAP_ULLONG  lBytes = 0;
 
-    TRows           mRows;          ///< Data rows
-    TRow*           mpPrompt;       ///< Prompt row for interactive rows
-    TRow*           mpHeader;       ///< Header row
+            if (lIt == mIndex.end()) {
+                //--------------------------------------------------------------
+                // New value: copy it into the index and measure it once.
+                //--------------------------------------------------------------
+                SAP_UINT    lCode = mFree.empty() ? (SAP_UINT)mEntries.size() : mFree.back();
 
-    EPrintOption    mPrintOption;   ///< Defines which part of the table to print
-    TStringStream   mOutput;        ///< Formatted output line
-    SAP_INT         mIndent;        ///< Indentation
+                if (mFree.empty()) {
+                    mEntries.emplace_back();
+                }
+                else {
+                    mFree.pop_back();
+                }
+                lIt = mIndex.emplace(mKey, lCode).first;
+
+                TEntry& lrNew = mEntries[lCode];
+
+                lrNew.mCell.mCellAttr = arCell.mCellAttr;
+                lrNew.mCell.borrow(lIt->first.data(), arCell.size());
+                lrNew.mCell.measure();
+                lrNew.mCell.mCode = lCode;
+                lrNew.mRefs       = 0;
+                lrNew.mPadWidth   = 0;
+                lrNew.mPadRight   = false;
+                lBytes = entryBytes(lIt->first);
+            }
 
-    TString         mHeadLine;      ///< Table header
-    TString         mInput;         ///< Input string for interactive rows
-    SAP_UINT        mOldAttr;       ///< Old console color and font
-    static SAP_UINT sCurAttr;       ///< Actual console color and font
-    TAttr           mAttr;          ///< Table attributes
-    TAttr           mOpAttr;        ///< Output operator attributes
+            TEntry& lrEntry = mEntries[lIt->second];
 
-public:
-    //--------------------------------------------------------------------------
-    /// Constructor.
-    //--------------------------------------------------------------------------
-    SfCTable(
-        const TString&  arHeadLine = "",      ///< Header line
-        const TAttr&    arAttr = TAttr() ):   ///< Attributes        
-        mRows(1),
-        mpPrompt(NULL),
-        mpHeader(NULL),
-        mPrintOption(PRINT_ALL),
-        mIndent(1),
-        mHeadLine(arHeadLine),
-        mOldAttr(),
-        mAttr(arAttr) {
+            lrEntry.mRefs++;
+            arCell.borrow(lrEntry.mCell.data(), lrEntry.mCell.size());
+            arCell.copyState(lrEntry.mCell);
+            return lBytes;
+        }
 
-        TRow& lrHeader = mRows.back();
+        //----------------------------------------------------------------------
+        /// Releases a code of a row, the entry goes with its last code. The
+        /// dictionary starts over when no entry is left.
+        /// @return Memory of a released entry, 0 if it is still used
+        //----------------------------------------------------------------------
+        SAP_ULLONG release( SAP_UINT aCode ) {  ///< dictionary code
+            TEntry& lrEntry = mEntries[aCode];
 
-        lrHeader.mRowAttr.set(R_HEADER);
-        lrHeader.mRowAttr.set(R_INVISIBLE);
+            if (--lrEntry.mRefs > 0) {
+                return 0;
+            }
 
-        mpHeader = &lrHeader;
-    }
+            unordered_map<TString, SAP_UINT>::iterator lIt = mIndex.find(key(lrEntry.mCell));
+            SAP_ULLONG  lBytes = entryBytes(lIt->first);
 
-    //--------------------------------------------------------------------------
-    /// Destructor.
-    //--------------------------------------------------------------------------
-    ~SfCTable() {
-    }
+            lrEntry.mCell   = TCell();
+            lrEntry.mPadded = TString();
+            mIndex.erase(lIt);
+            mFree.push_back(aCode);
 
-private:
-    void addCell(TCell&  arCell) {        ///< the new cell
-        TRow&   lrRow = mRows.back();
+            if (mFree.size() == mEntries.size()) {
+                mIndex.clear();
+                mEntries.clear();
+                mFree.clear();
+            }
+            return lBytes;
+        }
 
         //----------------------------------------------------------------------
-        // Check the row length.
+        /// The cell of an entry.
         //----------------------------------------------------------------------
-        if (lrRow.mCells.size() >= sMaxColCount) {
-            cerr << "SfCTable::operator<<(%s): too many cells.\n", arCell.mValue.c_str();
-            return;
+        TCell& cell( SAP_UINT aCode ) {         ///< dictionary code
+            return mEntries[aCode].mCell;
         }
 
-        if (mpHeader == &lrRow) {
-            //------------------------------------------------------------------
-            // Output goes into the header row.
-            //------------------------------------------------------------------
-            if (arCell.mCellAttr.test(FIXED) != 0) {
-                arCell.mCellAttr.mWidth = MAX(arCell.mCellAttr.mWidth, MAX(sMinColWidth, MIN(arCell.mValue.size(), sMaxColWidth)));
+        //----------------------------------------------------------------------
+        /// Returns the entry padded to the given column width.
+        //----------------------------------------------------------------------
+        const TString& padded(
+            SAP_UINT        aCode,          ///< dictionary code
+            TStringSize     aWidth,         ///< column width
+            bool            aRight ) {      ///< right alignment
+            TEntry& lrEntry = mEntries[aCode];
+
+            if (lrEntry.mPadWidth != aWidth || lrEntry.mPadRight != aRight) {
+                TStringSize lFill = aWidth - lrEntry.mCell.mDispWidth;
+
+                lrEntry.mPadded.clear();
+                lrEntry.mPadded.reserve(lrEntry.mCell.size() + lFill);
+
+                if (aRight) {
+                    lrEntry.mPadded.append(lFill, ' ');
+                    lrEntry.mPadded.append(lrEntry.mCell.data(), lrEntry.mCell.size());
+                }
+                else {
+                    lrEntry.mPadded.append(lrEntry.mCell.data(), lrEntry.mCell.size());
+                    lrEntry.mPadded.append(lFill, ' ');
+                }
+                lrEntry.mPadWidth = aWidth;
+                lrEntry.mPadRight = aRight;
             }
+            return lrEntry.mPadded;
+        }
+
+        //----------------------------------------------------------------------
+        /// Number of distinct values in use.
+        //----------------------------------------------------------------------
+        size_t size() const {
+            return mEntries.size() - mFree.size();
+        }
+    };
+
+    //==========================================================================
+    /// @class TDictCols
+    /// The DICT columns of a table, fixed by the header when the first data
+    /// row is added. Their cells are not kept in the rows: a row has a code
+    /// row in mCodes with its cell count and one code per dictionary, so a
+    /// DICT cell costs one code per row.
+    //==========================================================================
+    class TDictCols {
+        friend class    SfCTable;
+
+    private:
+        vector<SAP_INT>     mDictOf;    ///< column to dictionary, -1: cell in the row
+        vector<SAP_UINT>    mCellOf;    ///< column to cell in the row
+        deque<TDict>        mDicts;     ///< dictionary per DICT column
+        vector<SAP_UINT>    mCodes;     ///< code rows: cell count, then the codes
+        vector<SAP_UINT>    mFree;      ///< released code rows
+
+    public:
+        //----------------------------------------------------------------------
+        /// Length of a code row.
+        //----------------------------------------------------------------------
+        size_t stride() const {
+            return mDicts.size() + 1;
+        }
+
+        //----------------------------------------------------------------------
+        /// Dictionary of a column, -1 if the column is kept in the rows.
+        //----------------------------------------------------------------------
+        SAP_INT dictOf( const size_t iCell ) const {    ///< Column
+            return (iCell < mDictOf.size()) ? mDictOf[iCell] : -1;
+        }
+
+        //----------------------------------------------------------------------
+        /// Cell of a column in the row, the DICT columns are left out.
+        //----------------------------------------------------------------------
+        size_t cellOf( const size_t iCell ) const {     ///< Column
+            return (iCell < mCellOf.size()) ? mCellOf[iCell] : iCell - mDicts.size();
+        }
+
+        //----------------------------------------------------------------------
+        /// The code row, the cell count first.
+        //----------------------------------------------------------------------
+        SAP_UINT* codes( const SAP_UINT aRow ) {        ///< Code row
+            return &mCodes[aRow * stride()];
+        }
+
+        //----------------------------------------------------------------------
+        /// Takes an empty code row.
+        //----------------------------------------------------------------------
+        SAP_UINT alloc(void) {
+            SAP_UINT    lRow;
+
+            if (mFree.empty()) {
+                lRow = (SAP_UINT)(mCodes.size() / stride());
+                mCodes.resize(mCodes.size() + stride(), DICT_NONE);
+            }
+            else {
+                lRow = mFree.back();
+                mFree.pop_back();
+            }
+            mCodes[lRow * stride()] = 0;
+            return lRow;
+        }
+
+        //----------------------------------------------------------------------
+        /// Returns an emptied code row, all rows start over when none is left.
+        //----------------------------------------------------------------------
+        void recycle( const SAP_UINT aRow ) {              ///< Code row
+            mFree.push_back(aRow);
+
+            if (mFree.size() * stride() == mCodes.size()) {
+                mCodes.clear();
+                mFree.clear();
+            }
+        }
+    };
+
+    //==========================================================================
+    /// @class TColStat
+    /// Length statistics of a column, collected while cells are added.
+    /// The histogram has one bucket per width up to 63 and one bucket per
+    /// power of two above, so a quantile costs a constant number of steps.
+    //==========================================================================
+    class TColStat {
+        friend class    SfCTable;
+
+#   define COL_STAT_EXACT   64
+#   define COL_STAT_BUCKETS (COL_STAT_EXACT + 16)
+
+    private:
+        SAP_UINT        mCount;                     ///< number of cells
+        SAP_UINT        mNumbers;                   ///< number of numeric cells
+        TStringSize     mMax;                       ///< widest cell
+        SAP_UINT        mHist[COL_STAT_BUCKETS];    ///< width histogram
+        bool            mWrapped;                   ///< WRAP set by fitWidth
+
+    public:
+        //----------------------------------------------------------------------
+        /// Default constructor.
+        //----------------------------------------------------------------------
+        TColStat():
+            mCount(0),
+            mNumbers(0),
+            mMax(0),
+            mWrapped(false) {
+            memset(mHist, 0, sizeof(mHist));
+        }
+
+        //----------------------------------------------------------------------
+        /// Adds a cell width.
+        //----------------------------------------------------------------------
+        void add(
+            TStringSize     aWidth,         ///< display width of the cell
+            bool            aNumber ) {     ///< cell holds a number
+            size_t lBucket = aWidth;
+
+            if (aWidth >= COL_STAT_EXACT) {
+                for (lBucket = COL_STAT_EXACT; (aWidth >> 7) > 0 && lBucket < COL_STAT_BUCKETS - 1; aWidth >>= 1) {
+                    lBucket++;
+                }
+            }
+            mHist[lBucket]++;
+            mCount++;
+            mNumbers += aNumber ? 1 : 0;
+        }
+
+        //----------------------------------------------------------------------
+        /// Width that covers the given percentage of the cells.
+        //----------------------------------------------------------------------
+        TStringSize quantile( SAP_UINT aPercent ) const {  ///< 0 .. 100
+            SAP_ULLONG  lRank = ((SAP_ULLONG)mCount * aPercent + 99) / 100;
+            SAP_ULLONG  lSum  = 0;
+
+            for (size_t lBucket = 0; lBucket < COL_STAT_BUCKETS; lBucket++) {
+                lSum += mHist[lBucket];
+                if (lSum >= lRank && lSum > 0) {
+                    if (lBucket < COL_STAT_EXACT) {
+                        return lBucket;
+                    }
+                    return MIN(mMax, ((TStringSize)128 << (lBucket - COL_STAT_EXACT)) - 1);
+                }
+            }
+            return mMax;
+        }
+    };
+
+    //==========================================================================
+    /// @class TRingCol
+    /// Width counts of a column in ring mode. The widths of the rows in the
+    /// ring are counted, so the column width can shrink when the widest row
+    /// is overwritten, without a pass over the other rows.
+    //==========================================================================
+    class TRingCol {
+        friend class    SfCTable;
+
+    private:
+        vector<SAP_UINT>    mCount;     ///< rows per display width
+        TStringSize         mMax;       ///< widest row in the ring
+        TStringSize         mBase;      ///< column width without data
+
+    public:
+        //----------------------------------------------------------------------
+        /// Constructor.
+        //----------------------------------------------------------------------
+        TRingCol( TStringSize aBase = 0 ):     ///< width of the header cell
+            mMax(0),
+            mBase(aBase) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Counts the width of a new row.
+        //----------------------------------------------------------------------
+        void add( TStringSize aWidth ) {       ///< display width
+            if (mCount.size() <= aWidth) {
+                mCount.resize(aWidth + 1, 0);
+            }
+            mCount[aWidth]++;
+            mMax = MAX(mMax, aWidth);
+        }
+
+        //----------------------------------------------------------------------
+        /// Removes the width of an overwritten row.
+        /// @return The column width of the remaining rows
+        //----------------------------------------------------------------------
+        TStringSize drop( TStringSize aWidth ) {   ///< display width
+            if (aWidth < mCount.size() && mCount[aWidth] > 0) {
+                mCount[aWidth]--;
+            }
+
+            while (mMax > 0 && mCount[mMax] == 0) {
+                mMax--;
+            }
+            return MAX(mBase, mMax);
+        }
+    };
+
+    //==========================================================================
+    /// @typedef TCells
+    /// Container for the cells of a row.
+    /// A vector is reserved with the header's column count, so a row costs a
+    /// single allocation regardless of the number of columns.
+    //==========================================================================
+    typedef vector<TCell> TCells;
+
+    //==========================================================================
+    /// @class TRow
+    /// The row class stores the cells of each row.
+    /// A row can contain header cells or data cells, and it may contain input
+    /// from the terminal.
+    //==========================================================================
+    class TRow {
+        friend class    SfCTable;
+
+    private:
+        SfCTable*    mpSubTable;    ///< Subtable
+        TRow*        mpHeader;      ///< Header row
+        TCells       mCells;        ///< Cells within the row
+        TAttr        mRowAttr;      ///< Row layout flags
+        bool         mContinue;     ///< Linebreak in a column
+        SAP_UINT     mColorRow;     ///< Row in the cell colors of the rules
+        SAP_UINT     mCodeRow;      ///< Codes of the DICT cells, DICT_NONE: none
+        SAP_ULLONG   mHash;         ///< FNV-1a hash of the cell values
+
+    public:
+        //----------------------------------------------------------------------
+        /// Default constructor.
+        //----------------------------------------------------------------------
+        TRow() :
+            mpSubTable(NULL),
+            mpHeader(NULL),
+            mContinue(false),
+            mColorRow(0),
+            mCodeRow(DICT_NONE),
+            mHash(14695981039346656037ULL) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Move constructor.
+        /// The row owns its subtable, so it can be moved but not copied.
+        //----------------------------------------------------------------------
+        TRow( TRow&& arRow ) noexcept:      ///< the row to move.
+            mpSubTable(arRow.mpSubTable),
+            mpHeader(arRow.mpHeader),
+            mCells(std::move(arRow.mCells)),
+            mRowAttr(arRow.mRowAttr),
+            mContinue(arRow.mContinue),
+            mColorRow(arRow.mColorRow),
+            mCodeRow(arRow.mCodeRow),
+            mHash(arRow.mHash) {
+            arRow.mpSubTable = NULL;
+            arRow.mCodeRow   = DICT_NONE;
+        }
+
+        //----------------------------------------------------------------------
+        /// Move assignment operator.
+        //----------------------------------------------------------------------
+        TRow& operator=( TRow&& arRow ) noexcept {      ///< the row to move.
+            if (this != &arRow) {
+                if (mpSubTable) {
+                    delete mpSubTable;
+                }
+                mpSubTable = arRow.mpSubTable;
+                mpHeader   = arRow.mpHeader;
+                mCells     = std::move(arRow.mCells);
+                mRowAttr   = arRow.mRowAttr;
+                mContinue  = arRow.mContinue;
+                mColorRow  = arRow.mColorRow;
+                mCodeRow   = arRow.mCodeRow;
+                mHash      = arRow.mHash;
+                arRow.mpSubTable = NULL;
+                arRow.mCodeRow   = DICT_NONE;
+            }
+            return *this;
+        }
+
+        TRow( const TRow& ) = delete;
+        TRow& operator=( const TRow& ) = delete;
+
+        //----------------------------------------------------------------------
+        /// Clears the row for reuse. The subtable is released, the cell
+        /// vector keeps its capacity. The codes are released by the table.
+        //----------------------------------------------------------------------
+        void reset(void) {
+            if (mpSubTable) {
+                delete mpSubTable;
+                mpSubTable = NULL;
+            }
+            mCells.clear();
+            mRowAttr  = TAttr();
+            mContinue = false;
+            mHash     = 14695981039346656037ULL;
+        }
+
+        //----------------------------------------------------------------------
+        /// Adds the value of a new cell to the row hash. Each value ends
+        /// with the byte 0xFF, which does not occur in UTF-8, so the hash
+        /// tells "ab","c" from "a","bc".
+        //----------------------------------------------------------------------
+        void hashCell( const TCell& arCell ) {  ///< the new cell
+            const SAP_UC*   lpData = arCell.data();
+            SAP_ULLONG      lHash  = mHash;
+
+            for (TStringSize i = 0; i < arCell.size(); i++) {
+                lHash = (lHash ^ (unsigned char)lpData[i]) * 1099511628211ULL;
+            }
+            mHash = (lHash ^ 0xFF) * 1099511628211ULL;
+        }
+
+        //----------------------------------------------------------------------
+        /// Destructor.
+        //----------------------------------------------------------------------
+        ~TRow() {
+            if (mpSubTable) {
+                delete mpSubTable;
+            }
+        }
+    };
+
+    //==========================================================================
+    /// Container for the rows of a terminal table.
+    /// The first row in mRows is the header row, other rows contain data or
+    /// act as placeholders for sub-tables. The deque allocates the rows in
+    /// fixed blocks, so appending never moves existing rows and the cost per
+    /// row does not depend on the table size.
+    //==========================================================================
+    typedef deque<TRow>    TRows;
+
+public:
+    //==========================================================================
+    /// @class TLayout
+    /// Column layout shared by many tables, e.g. one table per host.
+    /// The header is defined and measured once. Each table keeps a copy of
+    /// the header row for its own output and merges its column widths into
+    /// the layout with atomic operations, so tables on different threads can
+    /// add rows concurrently. On print a table takes over the widest widths
+    /// of all tables, so the tables line up.
+    //==========================================================================
+    class TLayout {
+        friend class    SfCTable;
+
+    private:
+        TRow                                    mHeader;    ///< Header definition
+        size_t                                  mCols;      ///< Columns with shared widths
+        std::unique_ptr<std::atomic<TStringSize>[]> mpWidths; ///< Widest value per column
+
+    public:
+        //----------------------------------------------------------------------
+        /// Constructor. Copies the header row of the defining table.
+        //----------------------------------------------------------------------
+        TLayout( const TRow& arHeader ):        ///< Header row to share
+            mCols(arHeader.mCells.size()),
+            mpWidths(new std::atomic<TStringSize>[arHeader.mCells.size()]) {
+            mHeader.mCells   = arHeader.mCells;
+            mHeader.mRowAttr = arHeader.mRowAttr;
+
+            for (size_t lCol = 0; lCol < mCols; lCol++) {
+                mpWidths[lCol].store(arHeader.mCells[lCol].mCellAttr.mWidth, std::memory_order_relaxed);
+            }
+        }
+
+        //----------------------------------------------------------------------
+        /// Raises the shared width of a column.
+        //----------------------------------------------------------------------
+        void merge(
+            size_t          aCol,               ///< Column
+            TStringSize     aWidth ) {          ///< Width used by a table
+            if (aCol >= mCols) {
+                return;
+            }
+            TStringSize lOld = mpWidths[aCol].load(std::memory_order_relaxed);
+
+            while (lOld < aWidth &&
+                   !mpWidths[aCol].compare_exchange_weak(lOld, aWidth, std::memory_order_relaxed)) {
+            }
+        }
+
+        //----------------------------------------------------------------------
+        /// Widens the columns of a table's header to the shared widths.
+        //----------------------------------------------------------------------
+        void apply( TRow& arHeader ) {          ///< Header row of a table
+            size_t lCols = MIN(mCols, arHeader.mCells.size());
+
+            for (size_t lCol = 0; lCol < lCols; lCol++) {
+                TAttr& lrAttr = arHeader.mCells[lCol].mCellAttr;
+
+                if (!lrAttr.test(FIXED)) {
+                    lrAttr.mWidth = MAX(lrAttr.mWidth, mpWidths[lCol].load(std::memory_order_relaxed));
+                }
+            }
+        }
+
+        //----------------------------------------------------------------------
+        /// Number of columns.
+        //----------------------------------------------------------------------
+        size_t size(void) const {
+            return mCols;
+        }
+    };
+
+    typedef std::shared_ptr<TLayout>    TLayoutPtr;
+
+    //==========================================================================
+    /// @class TRule
+    /// Conditional format of a column. Threshold and range rules compare the
+    /// numeric value of a cell, match rules search the text with a regular
+    /// expression, and a gradient colors the cells as a heat map from green
+    /// at aLow to red at aHigh.
+    //==========================================================================
+    class TRule {
+        friend class    SfCTable;
+
+    public:
+        typedef enum ERule {
+            RULE_ABOVE,             ///< value > limit
+            RULE_BELOW,             ///< value < limit
+            RULE_RANGE,             ///< low <= value <= high
+            RULE_MATCH,             ///< text matches a regular expression
+            RULE_GRADIENT           ///< heat map between low and high
+        } ERule;
+
+    private:
+        ERule           mType;      ///< Rule type
+        SAP_DOUBLE      mLow;       ///< Lower limit
+        SAP_DOUBLE      mHigh;      ///< Upper limit
+        EColor          mColor;     ///< Color of matching cells
+        std::shared_ptr<const std::regex> mpRegex;  ///< Expression of RULE_MATCH
+
+        TRule(
+            ERule           aType,
+            SAP_DOUBLE      aLow,
+            SAP_DOUBLE      aHigh,
+            EColor          aColor ):
+            mType(aType),
+            mLow(aLow),
+            mHigh(aHigh),
+            mColor(aColor) {
+        }
+
+    public:
+        //----------------------------------------------------------------------
+        /// Colors values above the limit.
+        //----------------------------------------------------------------------
+        static TRule above(
+            SAP_DOUBLE      aLimit,         ///< Limit
+            EColor          aColor ) {      ///< Color
+            return TRule(RULE_ABOVE, aLimit, aLimit, aColor);
+        }
+
+        //----------------------------------------------------------------------
+        /// Colors values below the limit.
+        //----------------------------------------------------------------------
+        static TRule below(
+            SAP_DOUBLE      aLimit,         ///< Limit
+            EColor          aColor ) {      ///< Color
+            return TRule(RULE_BELOW, aLimit, aLimit, aColor);
+        }
+
+        //----------------------------------------------------------------------
+        /// Colors values within the limits.
+        //----------------------------------------------------------------------
+        static TRule range(
+            SAP_DOUBLE      aLow,           ///< Lower limit
+            SAP_DOUBLE      aHigh,          ///< Upper limit
+            EColor          aColor ) {      ///< Color
+            return TRule(RULE_RANGE, aLow, aHigh, aColor);
+        }
+
+        //----------------------------------------------------------------------
+        /// Colors text that contains a match of the expression.
+        //----------------------------------------------------------------------
+        static TRule match(
+            const TString&  arRegex,        ///< ECMAScript regular expression
+            EColor          aColor ) {      ///< Color
+            TRule lRule(RULE_MATCH, 0, 0, aColor);
+
+            lRule.mpRegex = std::make_shared<const std::regex>(arRegex, std::regex::optimize);
+            return lRule;
+        }
+
+        //----------------------------------------------------------------------
+        /// Colors values as heat map from green to red.
+        //----------------------------------------------------------------------
+        static TRule gradient(
+            SAP_DOUBLE      aLow,           ///< Value shown green
+            SAP_DOUBLE      aHigh ) {       ///< Value shown red
+            return TRule(RULE_GRADIENT, aLow, aHigh, COLOR_NONE);
+        }
+    };
+
+private:
+    //==========================================================================
+    /// @class TRules
+    /// Rules of the columns and the cell colors of the last evaluation. The
+    /// color of a cell is at mColors[row * mCols + column], 0 for none. The
+    /// spans mark the colored cells in the line being printed, including the
+    /// HIGHLIGHT cells of tables without rules.
+    //==========================================================================
+    class TRules {
+    public:
+        vector<vector<TRule> >  mRules;     ///< Rules per column
+        vector<SAP_UINT>        mColors;    ///< Evaluated cell colors
+        size_t                  mCols;      ///< Columns of mColors
+        vector<std::pair<size_t, SAP_UINT> > mSpans;  ///< Line offset and color, 0: line color
+
+        TRules():
+            mCols(0) {
+        }
+    };
+
+public:
+    //==========================================================================
+    /// @class TAgg
+    /// Aggregate function of groupBy and pivot. Sums, minimum, maximum and
+    /// average use the numeric value of the cells and skip cells that are
+    /// no numbers. Without a name the column is named after the function
+    /// and the source column, e.g. sum(load).
+    //==========================================================================
+    class TAgg {
+        friend class    SfCTable;
+
+    public:
+        typedef enum EAgg {
+            AGG_COUNT,              ///< number of rows
+            AGG_SUM,                ///< sum of the values
+            AGG_MIN,                ///< smallest value
+            AGG_MAX,                ///< largest value
+            AGG_AVG                 ///< average of the values
+        } EAgg;
+
+    private:
+        EAgg            mType;      ///< Function
+        size_t          mCol;       ///< Source column
+        TString         mName;      ///< Column name, empty: derived
+
+        TAgg(
+            EAgg            aType,
+            size_t          aCol,
+            const TString&  arName ):
+            mType(aType),
+            mCol(aCol),
+            mName(arName) {
+        }
+
+    public:
+        //----------------------------------------------------------------------
+        /// Counts the rows of a group.
+        //----------------------------------------------------------------------
+        static TAgg count( const TString& arName = "count" ) {  ///< Column name
+            return TAgg(AGG_COUNT, 0, arName);
+        }
+
+        //----------------------------------------------------------------------
+        /// Sums the values of a column.
+        //----------------------------------------------------------------------
+        static TAgg sum(
+            size_t          aCol,               ///< Source column
+            const TString&  arName = "" ) {     ///< Column name
+            return TAgg(AGG_SUM, aCol, arName);
+        }
+
+        //----------------------------------------------------------------------
+        /// Smallest value of a column.
+        //----------------------------------------------------------------------
+        static TAgg min(
+            size_t          aCol,               ///< Source column
+            const TString&  arName = "" ) {     ///< Column name
+            return TAgg(AGG_MIN, aCol, arName);
+        }
+
+        //----------------------------------------------------------------------
+        /// Largest value of a column.
+        //----------------------------------------------------------------------
+        static TAgg max(
+            size_t          aCol,               ///< Source column
+            const TString&  arName = "" ) {     ///< Column name
+            return TAgg(AGG_MAX, aCol, arName);
+        }
+
+        //----------------------------------------------------------------------
+        /// Average of the values of a column.
+        //----------------------------------------------------------------------
+        static TAgg avg(
+            size_t          aCol,               ///< Source column
+            const TString&  arName = "" ) {     ///< Column name
+            return TAgg(AGG_AVG, aCol, arName);
+        }
+    };
+
+private:
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellValue
+    /// Numeric value of a cell, as strtod reads it
+    /// @return false if the cell does not start with a number
+    //--------------------------------------------------------------------------
+    static bool cellValue(
+        const TCell&    arCell,                 ///< Cell
+        SAP_DOUBLE&     arValue ) {             ///< Value
+        SAP_UC          lBuffer[64];
+        TString         lText;
+        const SAP_UC*   lpText  = lBuffer;
+        SAP_UC*         lpEnd   = NULL;
+
+        if (arCell.size() < sizeof(lBuffer)) {
+            memcpy(lBuffer, arCell.data(), arCell.size());
+            lBuffer[arCell.size()] = 0;
+        }
+        else {
+            lText.assign(arCell.data(), arCell.size());
+            lpText = lText.c_str();
+        }
+        arValue = strtod(lpText, &lpEnd);
+        return lpEnd != lpText;
+    }
+
+    //==========================================================================
+    /// @class TAcc
+    /// Running value of an aggregate function
+    //==========================================================================
+    class TAcc {
+    public:
+        SAP_DOUBLE      mValue;     ///< Sum, minimum or maximum
+        SAP_ULLONG      mCount;     ///< Values seen
+
+        TAcc():
+            mValue(0),
+            mCount(0) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Adds the value of a cell, cells without a number are skipped.
+        //----------------------------------------------------------------------
+        void add(
+            const TAgg&     arAgg,          ///< Function
+            const TCell*    apCell ) {      ///< Cell of the column, NULL: none
+            SAP_DOUBLE  lValue;
+
+            if (arAgg.mType == TAgg::AGG_COUNT) {
+                mCount++;
+                return;
+            }
+
+            if (apCell == NULL || !cellValue(*apCell, lValue)) {
+                return;
+            }
+
+            if (mCount == 0 || arAgg.mType == TAgg::AGG_SUM || arAgg.mType == TAgg::AGG_AVG) {
+                mValue = (mCount == 0) ? lValue : mValue + lValue;
+            }
+            else if (arAgg.mType == TAgg::AGG_MIN) {
+                mValue = (lValue < mValue) ? lValue : mValue;
+            }
+            else {
+                mValue = (lValue > mValue) ? lValue : mValue;
+            }
+            mCount++;
+        }
+    };
+
+    //==========================================================================
+    /// @class TGroup
+    /// Group of groupBy and pivot: the first row for the key values, the
+    /// aggregates and, for the detail subtables, the rows of the group.
+    //==========================================================================
+    class TGroup {
+    public:
+        size_t          mFirst;     ///< First row of the group
+        vector<TAcc>    mAcc;       ///< Aggregates, per pivot value in pivot
+        vector<size_t>  mRows;      ///< Rows of the group, only for details
+
+        TGroup( size_t aFirst ):    ///< First row of the group
+            mFirst(aFirst) {
+        }
+    };
+
+public:
+
+    //==========================================================================
+    /// @class TColumn
+    /// Read-only view of caller data for appendColumns and appendRows: a
+    /// column of numbers or strings, with a stride for row major blocks.
+    /// The data is formatted into the table, it need not outlive the call.
+    //==========================================================================
+    class TColumn {
+        friend class    SfCTable;
+
+    public:
+        typedef enum EType {
+            COL_INT,                ///< SAP_INT values
+            COL_LLONG,              ///< SAP_LLONG values
+            COL_DOUBLE,             ///< SAP_DOUBLE values
+            COL_STRING,             ///< TString values
+            COL_CHARS               ///< zero terminated strings
+        } EType;
+
+    private:
+        EType           mType;      ///< Value type
+        const void*     mpData;     ///< First value
+        size_t          mSize;      ///< Number of values
+        size_t          mStride;    ///< Distance of the values in elements
+        TAttr           mAttr;      ///< Cell attributes
+
+    public:
+        //----------------------------------------------------------------------
+        /// Constructor for a column of values.
+        //----------------------------------------------------------------------
+        TColumn(
+            const SAP_INT*      apData,             ///< Values
+            size_t              aSize,              ///< Number of values
+            const TAttr&        arAttr = TAttr(),   ///< Cell attributes
+            size_t              aStride = 1 ):      ///< Distance of the values
+            mType(COL_INT), mpData(apData), mSize(aSize), mStride(aStride), mAttr(arAttr) {
+        }
+
+        TColumn(
+            const SAP_LLONG*    apData,             ///< Values
+            size_t              aSize,              ///< Number of values
+            const TAttr&        arAttr = TAttr(),   ///< Cell attributes
+            size_t              aStride = 1 ):      ///< Distance of the values
+            mType(COL_LLONG), mpData(apData), mSize(aSize), mStride(aStride), mAttr(arAttr) {
+        }
+
+        TColumn(
+            const SAP_DOUBLE*   apData,             ///< Values
+            size_t              aSize,              ///< Number of values
+            const TAttr&        arAttr = TAttr(),   ///< Cell attributes
+            size_t              aStride = 1 ):      ///< Distance of the values
+            mType(COL_DOUBLE), mpData(apData), mSize(aSize), mStride(aStride), mAttr(arAttr) {
+        }
+
+        TColumn(
+            const TString*      apData,             ///< Values
+            size_t              aSize,              ///< Number of values
+            const TAttr&        arAttr = TAttr(),   ///< Cell attributes
+            size_t              aStride = 1 ):      ///< Distance of the values
+            mType(COL_STRING), mpData(apData), mSize(aSize), mStride(aStride), mAttr(arAttr) {
+        }
+
+        TColumn(
+            const SAP_UC* const* apData,            ///< Values
+            size_t              aSize,              ///< Number of values
+            const TAttr&        arAttr = TAttr(),   ///< Cell attributes
+            size_t              aStride = 1 ):      ///< Distance of the values
+            mType(COL_CHARS), mpData(apData), mSize(aSize), mStride(aStride), mAttr(arAttr) {
+        }
+
+        //----------------------------------------------------------------------
+        /// Constructor for a vector of values.
+        //----------------------------------------------------------------------
+        template<typename T>
+        TColumn(
+            const vector<T>&    arData,             ///< Values
+            const TAttr&        arAttr = TAttr() ): ///< Cell attributes
+            TColumn(arData.data(), arData.size(), arAttr) {
+        }
+    };
+
+    //==========================================================================
+    /// @class TStats
+    /// Rendering statistics of a table or of all tables. The counters are
+    /// collected if SF_TABLE_STATS is defined, else they stay zero.
+    /// The global peak row memory is the peak of the largest table.
+    //==========================================================================
+    class TStats {
+        friend class    SfCTable;
+
+    private:
+        SAP_ULLONG      mValue[STAT_COUNT]; ///< Counters
+
+    public:
+        //----------------------------------------------------------------------
+        /// Constructor.
+        //----------------------------------------------------------------------
+        TStats() {
+            reset();
+        }
+
+        //----------------------------------------------------------------------
+        /// Sets all counters to zero.
+        //----------------------------------------------------------------------
+        void reset(void) {
+            for (size_t iStat = 0; iStat < STAT_COUNT; iStat++) {
+                mValue[iStat] = 0;
+            }
+        }
+
+        //----------------------------------------------------------------------
+        /// Value of a counter.
+        //----------------------------------------------------------------------
+        SAP_ULLONG get( const EStat aStat ) const {     ///< Counter
+            return mValue[aStat];
+        }
+
+        //----------------------------------------------------------------------
+        /// Name of a counter.
+        //----------------------------------------------------------------------
+        static const SAP_UC* getName( const EStat aStat ) {    ///< Counter
+            static const SAP_UC* lNames[STAT_COUNT] = {
+                "rows", "cells", "bytes", "escape bytes", "write calls", "flushes",
+                "peak row bytes", "ingest ns", "width ns", "render ns", "io ns"
+            };
+            return lNames[aStat];
+        }
+
+        //----------------------------------------------------------------------
+        /// Adds the counters as rows to an empty table, to print them.
+        //----------------------------------------------------------------------
+        void fill( SfCTable& arTable ) const {  ///< Table to fill
+            arTable.hdr() << "Counter" << (TAttr() + NUMBER) << "Value";
+
+            for (size_t iStat = 0; iStat < STAT_COUNT; iStat++) {
+                arTable.row();
+                arTable << getName((EStat)iStat) << mValue[iStat];
+            }
+        }
+    };
+
+private:
+    //--------------------------------------------------------------------------
+    /// @enum ELine
+    /// Position of a separator line.
+    //--------------------------------------------------------------------------
+    typedef enum ELine {
+        LINE_TOP,              ///< above the header
+        LINE_MID,              ///< below the header and for R_LINE rows
+        LINE_BOTTOM,           ///< below the last row
+        LINE_COUNT
+    } ELine;
+
+    //==========================================================================
+    /// @struct TBorderStyle
+    /// Characters of a border style. Each character has a display width of
+    /// one. A line without joins is not printed.
+    //==========================================================================
+    struct TBorderStyle {
+        const SAP_UC*   mSep;               ///< Column separator, NULL: sSepStr
+        const SAP_UC*   mFill;              ///< Fill of the separator lines
+        const SAP_UC*   mJoin[LINE_COUNT][3]; ///< Left, inner and right joins
+    };
+
+    //==========================================================================
+    /// @struct TBorderCache
+    /// Separator lines of the current style and column widths. The lines are
+    /// built when the widths or the style change and then copied as a whole.
+    //==========================================================================
+    struct TBorderCache {
+        EBorder                 mBorder;            ///< Style of the lines
+        SAP_INT                 mIndent;            ///< Indentation of the table
+        TStringSize             mLineWidth;         ///< Padded line width
+        vector<TStringSize>     mWidths;            ///< Printed column widths
+        TString                 mLines[LINE_COUNT]; ///< Lines, empty: not printed
+        bool                    mValid;             ///< The lines are built
+
+        TBorderCache():
+            mBorder(BORDER_ASCII),
+            mIndent(0),
+            mLineWidth(0),
+            mValid(false) {
+        }
+    };
+
+
+    TRows           mRows;          ///< Data rows
+    TRow*           mpPrompt;       ///< Prompt row for interactive rows
+    TRow*           mpHeader;       ///< Header row
+    TRow*           mpRow;          ///< Row that receives the cells
+    size_t          mRingSize;      ///< Ring capacity in rows, 0: no ring
+    size_t          mRingHead;      ///< Slot of the oldest row in the ring
+    vector<TRingCol> mRingCols;     ///< Width counts per column in ring mode
+    vector<TRow>    mFreeRows;      ///< Rows released by a page flush
+    TLayoutPtr      mpLayout;       ///< Shared layout, NULL: own layout
+
+    EPrintOption    mPrintOption;   ///< Defines which part of the table to print
+    std::unique_ptr<TStringStream> mpOwnOutput; ///< Line buffer of a top level table
+    TStringStream&  mOutput;        ///< Formatted output line, shared with subtables
+    SAP_INT         mIndent;        ///< Indentation
+    SAP_UINT        mMaxColCount;   ///< Maximum column count, 0: no limit
+    SAP_UINT        mPageLength;    ///< Rows kept before flush, 0: no limit
+    TStringSize     mViewWidth;     ///< Viewport width, 0: no viewport
+    size_t          mViewOffset;    ///< First scrolled column of the viewport
+    size_t          mViewFrozen;    ///< Leading columns that never scroll
+    vector<size_t>  mViewCols;      ///< Columns visible in the viewport
+
+    TString         mHeadLine;      ///< Table header
+    TString         mInput;         ///< Input string for interactive rows
+    SAP_UINT        mOldAttr;       ///< Old console color and font
+    static SAP_UINT sCurAttr;       ///< Actual console color and font
+    TAttr           mAttr;          ///< Table attributes
+    TAttr           mOpAttr;        ///< Output operator attributes
+    std::unique_ptr<TDictCols> mpDict; ///< DICT columns, NULL: none
+    bool            mDictFixed;     ///< The DICT columns are fixed
+    std::unique_ptr<TRules> mpRules; ///< Conditional formats, on first use
+    vector<TColStat> mColStats;     ///< Length statistics per column, for fitWidth
+    TStringSize     mFitWidth;      ///< Target width for fitWidth, 0: off
+    SAP_ULLONG      mLinesOut;      ///< Lines written by endline
+    SAP_ULLONG      mBytesOut;      ///< Text bytes written by endline
+    SfCTable*       mpParent;       ///< Superior table, NULL: top level
+    SAP_ULLONG      mBytes;         ///< Memory of the rows and subtables
+    SAP_ULLONG      mBudget;        ///< Byte budget of the rows, 0: no limit
+    EBudget         mBudgetPolicy;  ///< Overflow policy of the budget
+    SAP_ULLONG      mRejected;      ///< Rows and cells dropped by the budget
+    bool            mRejectRow;     ///< Cells of the current row are dropped
+    FILE*           mpSpill;        ///< Pages spilled by the budget, NULL: none
+    size_t          mSpillRows;     ///< Rows written completely to mpSpill
+    EBorder         mBorder;        ///< Style of lines and column separators
+    TBorderCache    mBorderCache;   ///< Separator lines of the current layout
+#ifdef SF_TABLE_STATS
+    TStats          mStats;         ///< Rendering statistics
+    static std::atomic<SAP_ULLONG> sStats[STAT_COUNT]; ///< Statistics of all tables
+#endif
+    TExpand         mExpand;        ///< Fills a lazy subtable, empty if filled
+    bool            mExpanded;      ///< Subtable rows are printed
+    bool            mTree;          ///< Mark subtables as tree nodes
+
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    SfCTable(
+        const TString&  arHeadLine = "",      ///< Header line
+        const TAttr&    arAttr = TAttr() ):   ///< Attributes        
+        mRows(1),
+        mpPrompt(NULL),
+        mpHeader(NULL),
+        mpRow(NULL),
+        mRingSize(0),
+        mRingHead(0),
+        mPrintOption(PRINT_ALL),
+        mpOwnOutput(new TStringStream),
+        mOutput(*mpOwnOutput),
+        mIndent(1),
+        mMaxColCount(sMaxColCount),
+        mPageLength(sPageLength),
+        mViewWidth(0),
+        mViewOffset(0),
+        mViewFrozen(0),
+        mHeadLine(arHeadLine),
+        mOldAttr(),
+        mAttr(arAttr),
+        mDictFixed(false),
+        mFitWidth(0),
+        mLinesOut(0),
+        mBytesOut(0),
+        mpParent(NULL),
+        mBytes(0),
+        mBudget(0),
+        mBudgetPolicy(BUDGET_FLUSH),
+        mRejected(0),
+        mRejectRow(false),
+        mpSpill(NULL),
+        mSpillRows(0),
+        mBorder(BORDER_ASCII),
+        mExpanded(true),
+        mTree(false) {
+
+        TRow& lrHeader = mRows.back();
+
+        lrHeader.mRowAttr.set(R_HEADER);
+        lrHeader.mRowAttr.set(R_INVISIBLE);
+
+        mpHeader = &lrHeader;
+        mpRow    = &lrHeader;
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Constructor for subtables.
+    /// Tables are printed one line after the other, so a subtable renders
+    /// into the line buffer of its parent and has no stream of its own.
+    //--------------------------------------------------------------------------
+    SfCTable(
+        SfCTable&       arParent,             ///< Superior table
+        const TAttr&    arAttr ):             ///< Attributes
+        mRows(1),
+        mpPrompt(NULL),
+        mpHeader(NULL),
+        mpRow(NULL),
+        mRingSize(0),
+        mRingHead(0),
+        mPrintOption(PRINT_ALL),
+        mOutput(arParent.mOutput),
+        mIndent(arParent.mIndent + 4),
+        mMaxColCount(arParent.mMaxColCount),
+        mPageLength(arParent.mPageLength),
+        mViewWidth(0),
+        mViewOffset(0),
+        mViewFrozen(0),
+        mOldAttr(),
+        mAttr(arAttr),
+        mDictFixed(false),
+        mFitWidth(0),
+        mLinesOut(0),
+        mBytesOut(0),
+        mpParent(&arParent),
+        mBytes(0),
+        mBudget(0),
+        mBudgetPolicy(BUDGET_FLUSH),
+        mRejected(0),
+        mRejectRow(false),
+        mpSpill(NULL),
+        mSpillRows(0),
+        mBorder(arParent.mBorder),
+        mExpanded(true),
+        mTree(arParent.mTree) {
+
+        TRow& lrHeader = mRows.back();
+
+        lrHeader.mRowAttr.set(R_HEADER);
+        lrHeader.mRowAttr.set(R_INVISIBLE);
+
+        mpHeader = &lrHeader;
+        mpRow    = &lrHeader;
+    }
+
+public:
+
+    //--------------------------------------------------------------------------
+    /// Destructor.
+    //--------------------------------------------------------------------------
+    ~SfCTable() {
+        if (mpSpill != NULL) {
+            fclose(mpSpill);
+        }
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// SfCTable::fitCell
+    /// Sets the width of a measured data cell and widens its column.
+    //--------------------------------------------------------------------------
+    void fitCell(
+        TCell&          arCell,                 ///< Measured cell
+        TCell&          arHdr,                  ///< Header cell of the column
+        const size_t    iCell ) {               ///< Column
+        //----------------------------------------------------------------------
+        // Set the cell width.
+        //----------------------------------------------------------------------
+        if (arHdr.mCellAttr.test(FIXED)) {
+            arCell.mCellAttr.mWidth = arHdr.mCellAttr.mWidth;
+        }
+        else {
+            //------------------------------------------------------------------
+            // The cell width is the maximum of:
+            // - the cell attribute width,
+            // - the header attribute width, and
+            // - the display width of the data in the cell (taking line
+            //   breaks into account).
+            //------------------------------------------------------------------
+            TStringSize lSize = arCell.mDispWidth;
+            TStringSize lWidth = MIN(sMaxColWidth, MAX(MAX(lSize, arCell.mCellAttr.mWidth), arHdr.mCellAttr.mWidth));
+
+            if ((mRingSize > 0) && !arCell.mCellAttr.test(MERGE)) {
+                while (mRingCols.size() <= iCell) {
+                    mRingCols.push_back(TRingCol(mpHeader->mCells[mRingCols.size()].mCellAttr.mWidth));
+                }
+                mRingCols[iCell].add(MIN(sMaxColWidth, lSize));
+            }
+
+            arCell.mCellAttr.mWidth = lWidth;
+
+            if ((arHdr.mCellAttr.mWidth < lWidth) && !arCell.mCellAttr.test(MERGE)) {
+                arHdr.mCellAttr.mWidth = lWidth;
+
+                if (mpLayout) {
+                    mpLayout->merge(iCell, lWidth);
+                }
+            }
+
+            if ((mFitWidth > 0) && !arCell.mCellAttr.test(MERGE)) {
+                if (mColStats.size() <= iCell) {
+                    mColStats.resize(iCell + 1);
+                }
+                TColStat& lrStat = mColStats[iCell];
+
+                lrStat.add(lSize, arCell.mCellAttr.test(NUMBER));
+                lrStat.mMax = MAX(lrStat.mMax, lSize);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addCell
+    /// Adds a cell to the current row. Header flags are merged into data
+    /// cells, boolean values are converted and DICT columns interned.
+    //--------------------------------------------------------------------------
+    void addCell(TCell&&  arCell) {       ///< the new cell, moved into the row
+        TRow&   lrRow = *mpRow;
+        size_t  iCell = cellCount(lrRow);
+        SF_STAT(TStatTimer lTimer(&mStats, STAT_NS_INGEST);)
+
+        //----------------------------------------------------------------------
+        // The row was rejected by the budget, mpRow is the row before.
+        //----------------------------------------------------------------------
+        if (mRejectRow) {
+            admitCell(arCell);
+            return;
+        }
+
+        //----------------------------------------------------------------------
+        // Check the row length.
+        //----------------------------------------------------------------------
+        if ((mMaxColCount > 0) && (iCell >= mMaxColCount)) {
+            cerr << "SfCTable::operator<<(" << TString(arCell.data(), arCell.size())
+                 << "): too many cells, limit is " << mMaxColCount << ".\n";
+            return;
+        }
+
+        if (mpHeader == &lrRow) {
+            //------------------------------------------------------------------
+            // Output goes into the header row.
+            //------------------------------------------------------------------
+            arCell.measure();
+
+            if (arCell.mCellAttr.test(FIXED) != 0) {
+                arCell.mCellAttr.mWidth = MAX(arCell.mCellAttr.mWidth, MAX(sMinColWidth, MIN(arCell.mDispWidth, sMaxColWidth)));
+            }
+        }
+        else {
+            //------------------------------------------------------------------
+            // Output is table data.
+            //------------------------------------------------------------------
+            if (mpHeader->mCells.size() <= iCell) {
+                mpHeader->mCells.resize(iCell + 1);
+            }
+
+            TCell&    lrHdr = mpHeader->mCells[iCell];
+
+            //------------------------------------------------------------------
+            // Merge cell flags and header flags.
+            //------------------------------------------------------------------
+            arCell.mCellAttr.mFlags |= lrHdr.mCellAttr.mFlags;
+
+            //------------------------------------------------------------------
+            // Convert boolean cell values.
+            //------------------------------------------------------------------
+            bool lTrue = !(arCell.size() == 1 && arCell.data()[0] == '0');
+
+            if (arCell.mCellAttr.test(BOOL)) {
+                arCell.borrow(lTrue ? "true" : "false", lTrue ? 4 : 5);
+            }
+            else if (arCell.mCellAttr.test(YESNO)) {
+                arCell.borrow(lTrue ? "yes" : "no", lTrue ? 3 : 2);
+            }
+
+            if (!admitCell(arCell)) {
+                return;
+            }
+
+            //------------------------------------------------------------------
+            // Intern the values of DICT columns, measure all others.
+            //------------------------------------------------------------------
+            if (!internCell(arCell, iCell)) {
+                arCell.measure();
+            }
+
+            fitCell(arCell, lrHdr, iCell);
+        }
+
+        SF_STAT(addStat(&mStats, STAT_CELLS, 1);)
+
+        if (arCell.mCode == DICT_NONE) {
+            addBytes(cellBytes(arCell));
+        }
+        lrRow.hashCell(arCell);
+        storeCell(lrRow, std::move(arCell));
+    }
+
+protected:
+    //--------------------------------------------------------------------------
+    /// SfCTable::digits
+    /// Writes an unsigned number backwards into a buffer
+    /// @return Start of the digits
+    //--------------------------------------------------------------------------
+    static SAP_UC* digits(
+        SAP_UC*         apEnd,                  ///< End of the buffer
+        SAP_ULLONG      aValue,                 ///< Value
+        const SAP_UINT  aBase ) {               ///< 10 or 16
+        do {
+            *--apEnd = "0123456789abcdef"[aValue % aBase];
+            aValue  /= aBase;
+        } while (aValue > 0);
+        return apEnd;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::decimal
+    /// Writes a double backwards into a buffer like %g, if it has at most six
+    /// significant digits and needs no exponent. The other values are left to
+    /// snprintf.
+    /// @return Start of the digits or NULL
+    //--------------------------------------------------------------------------
+    static SAP_UC* decimal(
+        SAP_UC*             apEnd,              ///< End of the buffer
+        const SAP_DOUBLE    aValue ) {          ///< Value
+        SAP_DOUBLE  lAbs   = aValue < 0 ? -aValue : aValue;
+        SAP_DOUBLE  lScale = 1;
+
+        if (!(lAbs >= 1e-4 && lAbs < 1e6)) {
+            return NULL;
+        }
+
+        //----------------------------------------------------------------------
+        // Find the first scale that gives an integer below 1e6. The value is
+        // then so close to it that %g rounds to the same digits.
+        //----------------------------------------------------------------------
+        for (SAP_INT lFrac = 0; lFrac < 10; lFrac++, lScale *= 10) {
+            SAP_DOUBLE  lScaled = lAbs * lScale;
+            SAP_ULLONG  lDigits = (SAP_ULLONG)lScaled;
+
+            if (lScaled >= 1e6) {
+                return NULL;
+            }
+
+            if ((SAP_DOUBLE)lDigits != lScaled) {
+                continue;
+            }
+
+            while (lFrac > 0 && lDigits % 10 == 0) {
+                lDigits /= 10;
+                lFrac--;
+            }
+
+            if (lFrac > 0) {
+                for (SAP_INT iFrac = 0; iFrac < lFrac; iFrac++) {
+                    *--apEnd = (SAP_UC)('0' + lDigits % 10);
+                    lDigits /= 10;
+                }
+                *--apEnd = '.';
+            }
+            apEnd = digits(apEnd, lDigits, 10);
+
+            if (aValue < 0) {
+                *--apEnd = '-';
+            }
+            return apEnd;
+        }
+        return NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addTyped
+    /// Adds a data cell of a typed schema (see SfCTypedTable). The value is
+    /// formatted and the flags are complete, so only the width is evaluated.
+    //--------------------------------------------------------------------------
+    void addTyped(
+        TString&&       arValue,                ///< Formatted value
+        const TAttr&    arAttr ) {              ///< Column flags and width
+        SF_STAT(TStatTimer lTimer(&mStats, STAT_NS_INGEST);)
+        TCell   lCell(std::move(arValue), arAttr);
+
+        if (!admitCell(lCell)) {
+            return;
+        }
+        lCell.measure();
+        fitCell(lCell, mpHeader->mCells[mpRow->mCells.size()], mpRow->mCells.size());
+        SF_STAT(addStat(&mStats, STAT_CELLS, 1);)
+        addBytes(cellBytes(lCell));
+        mpRow->hashCell(lCell);
+        mpRow->mCells.emplace_back(std::move(lCell));
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addTyped
+    /// Adds a borrowed constant, e.g. the text of a boolean.
+    //--------------------------------------------------------------------------
+    void addTyped(
+        const TRef&     arRef,                  ///< Constant text
+        const TAttr&    arAttr ) {              ///< Column flags and width
+        SF_STAT(TStatTimer lTimer(&mStats, STAT_NS_INGEST);)
+        TCell   lCell(arRef, arAttr);
+
+        if (!admitCell(lCell)) {
+            return;
+        }
+        lCell.measure();
+        fitCell(lCell, mpHeader->mCells[mpRow->mCells.size()], mpRow->mCells.size());
+        SF_STAT(addStat(&mStats, STAT_CELLS, 1);)
+        addBytes(cellBytes(lCell));
+        mpRow->hashCell(lCell);
+        mpRow->mCells.emplace_back(std::move(lCell));
+    }
+
+public:
+    //--------------------------------------------------------------------------
+    /// Sets or clears the SIGALRM flag. A signal handler sets the flag to
+    /// interrupt a waiting getInput().
+    //--------------------------------------------------------------------------
+    static void setAlarm( bool aValue ) {        ///< new \c sAlarmed flag value.
+        sAlarmed = aValue;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Reads a line from the terminal. The line is returned as typed,
+    /// including spaces, without the line end.
+    /// @retval    true    if some data was read.
+    ///    @retval    false    the timeout has expired, the alarm flag is set or
+    ///                     the input is closed.
+    //--------------------------------------------------------------------------
+    bool getInput(
+            TString&         arInput,           ///< the data read.
+            const SAP_INT    aTimeout = -1) {   ///< input timeout (seconds)
+        
+        std::chrono::steady_clock::time_point lDeadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(MAX(aTimeout, 0));
+        SAP_INT       lWait = -1;
+        SAP_INT       lRc   = 0;
+
+        if (spAsync) {
+            spAsync->flush();
+        }
+
+        for (;;) {
+            if (takeLine(arInput)) {
+                return true;
+            }
+
+            if (sAlarmed) {
+                return false;
+            }
+
+            if (aTimeout >= 0) {
+                lWait = (SAP_INT)std::chrono::duration_cast<std::chrono::milliseconds>(
+                    lDeadline - std::chrono::steady_clock::now()).count();
+                lWait = MAX(lWait, 0);
+            }
+            lRc = readInput(lWait);
+
+            if (lRc < 0) {
+                return takeRest(arInput);
+            }
+
+            if (lRc == 0 && lWait == 0) {
+                return false;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Reads a line from the terminal without waiting. An event loop calls
+    /// it whenever getInputFd() is readable, so prompts do not need a thread
+    /// blocked in getInput().
+    /// @retval    true    a complete line was read.
+    ///    @retval    false    the line is not complete yet.
+    //--------------------------------------------------------------------------
+    bool pollInput(
+            TString&         arInput ) {        ///< the data read.
+        SAP_INT       lRc = 0;
+
+        while (!takeLine(arInput)) {
+            lRc = readInput(0);
+
+            if (lRc < 0) {
+                return takeRest(arInput);
+            }
+
+            if (lRc == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getInputFd
+    /// File descriptor of the terminal input for an external event loop
+    //--------------------------------------------------------------------------
+    static SAP_INT getInputFd(void);
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::isInputClosed
+    /// The input reached end of file
+    //--------------------------------------------------------------------------
+    static bool isInputClosed(void) {
+        return sInputEof && sInput.empty();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setHeader
+    /// Use the header of the reference table, see setLayout.
+    //--------------------------------------------------------------------------
+    void setHeader( SfCTable*    apRef ) {        ///< Reference table
+        setLayout(apRef->shareLayout());
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::shareLayout
+    /// Returns the layout of this table for other tables. The first call
+    /// creates the layout from the current header.
+    //--------------------------------------------------------------------------
+    TLayoutPtr shareLayout(void) {
+        if (!mpLayout) {
+            mpLayout = std::make_shared<TLayout>(*mpHeader);
+        }
+        return mpLayout;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setLayout
+    /// Use a shared layout instead of defining a header. Call it before the
+    /// first row is added.
+    //--------------------------------------------------------------------------
+    void setLayout( const TLayoutPtr& arLayout ) {    ///< Shared layout
+        mpLayout = arLayout;
+        mpHeader->mCells   = arLayout->mHeader.mCells;
+        mpHeader->mRowAttr = arLayout->mHeader.mRowAttr;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::redirect
+    /// Redirect output of the table into a given file
+    //--------------------------------------------------------------------------
+    static void redirect( FILE* apOut ) {        ///< Output file descriptor
+        if (spAsync) {
+            spAsync->flush();
+        }
+#ifdef SF_ZLIB
+        stopZip();
+#endif
+        if (spOut) {
+            fclose(spOut);
+        }
+        spOut = apOut;
+    }
+
+#ifdef SF_ZLIB
+    //--------------------------------------------------------------------------
+    /// SfCTable::redirect
+    /// Redirect output of the table into a compressed file. Lines are
+    /// compressed in blocks of 1MB, with aThread by a compressor thread.
+    /// The file is complete after the next redirect or at exit, flush()
+    /// makes the output so far readable. SfCZipOut::view() shows the file.
+    /// If the format is not supported, the output is not redirected and the
+    /// caller keeps the file.
+    /// @return false if the format is not supported
+    //--------------------------------------------------------------------------
+    static bool redirect(
+        FILE*                       apOut,              ///< Output file descriptor
+        const SfCZipOut::EFormat    aFormat,            ///< Compression format
+        const SAP_INT               aLevel  = 6,        ///< Compression level
+        const bool                  aThread = false ) { ///< Compress in a thread
+        static bool lAtExit = false;
+
+        if (apOut == NULL) {
+            redirect(apOut);
+            return false;
+        }
+
+        SfCZipOut*  lpZip = new SfCZipOut(apOut, aFormat, aLevel, aThread);
+
+        if (!lpZip->isOk()) {
+            delete lpZip;
+            return false;
+        }
+        redirect(apOut);
+        spZip = lpZip;
+
+        if (!lAtExit) {
+            lAtExit = true;
+            atexit(stopZip);
+        }
+        return true;
+    }
+#endif
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setAsync
+    /// Hand rendered lines over to a writer thread, so that printing does not
+    /// wait for the terminal or the file. The queue holds aCapacity lines,
+    /// aPolicy decides what happens if it is full. Capacity 0 writes all
+    /// pending lines and returns to synchronous output.
+    /// The queue takes whole lines from several threads. The console color
+    /// (sCurAttr) and the redirect file (spOut) are shared statics without
+    /// a lock: tables on different threads print concurrently only without
+    /// colors, and redirect() or setAsync() must not run during a print.
+    //--------------------------------------------------------------------------
+    static void setAsync(
+        const size_t                aCapacity,          ///< Queue size in lines
+        const SfCAsyncOut::EPolicy  aPolicy = SfCAsyncOut::QUEUE_BLOCK ) {
+        static bool lAtExit = false;
+
+        if (spAsync) {
+            spAsync->flush();
+        }
+        stopAsync();
+        spAsync = (aCapacity > 0) ? new SfCAsyncOut(aCapacity, aPolicy) : NULL;
+
+        if (spAsync && !lAtExit) {
+            lAtExit = true;
+            atexit(stopAsync);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::flush
+    /// Queue the lines coalesced by the calling thread and wait until all
+    /// lines are written
+    //--------------------------------------------------------------------------
+    static void flush(void) {
+        if (spAsync) {
+            spAsync->flush();
+        }
+#ifdef SF_ZLIB
+        if (spZip) {
+            spZip->flush();
+        }
+#endif
+        cout.flush();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::wait
+    /// Wait until all queued lines are written
+    //--------------------------------------------------------------------------
+    static void wait(void) {
+        if (spAsync) {
+            spAsync->wait();
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getStats
+    /// Rendering statistics of this table, see SF_TABLE_STATS
+    //--------------------------------------------------------------------------
+    TStats getStats(void) const {
+#ifdef SF_TABLE_STATS
+        return mStats;
+#else
+        return TStats();
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getGlobalStats
+    /// Rendering statistics of all tables, see SF_TABLE_STATS
+    //--------------------------------------------------------------------------
+    static TStats getGlobalStats(void) {
+        TStats  lStats;
+#ifdef SF_TABLE_STATS
+        for (size_t iStat = 0; iStat < STAT_COUNT; iStat++) {
+            lStats.mValue[iStat] = sStats[iStat].load(std::memory_order_relaxed);
+        }
+#endif
+        return lStats;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::resetStats
+    /// Sets the statistics of this table to zero. The row memory stays.
+    //--------------------------------------------------------------------------
+    void resetStats(void) {
+#ifdef SF_TABLE_STATS
+        mStats.reset();
+        mStats.mValue[STAT_PEAK_ROW_BYTES] = mBytes;
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::resetGlobalStats
+    /// Sets the statistics of all tables to zero
+    //--------------------------------------------------------------------------
+    static void resetGlobalStats(void) {
+#ifdef SF_TABLE_STATS
+        for (size_t iStat = 0; iStat < STAT_COUNT; iStat++) {
+            sStats[iStat].store(0);
+        }
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setAttr
+    /// Sets the colors and attributes for output
+    //--------------------------------------------------------------------------
+    static SAP_UINT setAttr(const SAP_UINT aAttr);    ///< New colors and attributes
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getTermWidth
+    /// Width of the terminal in columns, 80 if it cannot be detected
+    //--------------------------------------------------------------------------
+    static TStringSize getTermWidth(void);
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getTermColors
+    /// Colors of the terminal. Detected on first use: output to a file or
+    /// pipe, NO_COLOR, or TERM=dumb print without colors and escapes.
+    //--------------------------------------------------------------------------
+    static ETermColors getTermColors(void) {
+        static bool lDetected = sTermColorsSet || setTermColors(detectTermColors());
+
+        (void)lDetected;
+        return (ETermColors)sTermColors;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setTermColors
+    /// Overrides the detected colors, e.g. to keep colors in a pipe to less -R
+    //--------------------------------------------------------------------------
+    static bool setTermColors( const ETermColors aColors ) {   ///< Terminal colors
+        sTermColors    = aColors;
+        sTermColorsSet = true;
+        buildPalette();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::fitWidth
+    /// Fit the column widths into the given total width on each print, 0 uses
+    /// the terminal width. Columns get their widest value if possible, else
+    /// at least the width covering 95% of their values and their header
+    /// label. Text columns that get narrower than their widest value wrap,
+    /// numbers are never shrunk below their widest value.
+    //--------------------------------------------------------------------------
+    void fitWidth( const TStringSize aWidth = 0 ) {   ///< Target width
+        if (mFitWidth == 0) {
+            evalStats();
+        }
+        mFitWidth = (aWidth > 0) ? aWidth : getTermWidth();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setTableLength
+    /// Set max number of table rows for output. 0 prints all rows, which is
+    /// the default, a negative length prints the last rows.
+    //--------------------------------------------------------------------------
+    inline static void setTableLength( const SAP_INT aTableLength ) {
+        sTableLength = aTableLength;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getTableLength
+    /// get max number of table rows for output
+    //--------------------------------------------------------------------------
+    inline static SAP_INT getTableLength() {
+        return sTableLength;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setPageLength
+    /// Set max number of table rows
+    //--------------------------------------------------------------------------
+    inline static void setPageLength( const SAP_UINT    aPageLength ) {
+        sPageLength = aPageLength;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getPageLength
+    /// Get max table length
+    //--------------------------------------------------------------------------
+    inline static SAP_INT getPageLength() {
+        return sPageLength;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setMaxColCount
+    /// Set the default max number of columns for new tables, 0: no limit
+    //--------------------------------------------------------------------------
+    inline static void setMaxColCount( const SAP_UINT aMaxColCount ) {
+        sMaxColCount = aMaxColCount;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setLimits
+    /// Set the limits of this table and its future subtables: the max number
+    /// of columns and the number of rows kept before the table is flushed.
+    /// Zero disables a limit.
+    //--------------------------------------------------------------------------
+    void setLimits(
+        const SAP_UINT  aMaxColCount,       ///< Max columns per row
+        const SAP_UINT  aPageLength ) {     ///< Max rows before flush
+        mMaxColCount = aMaxColCount;
+        mPageLength  = aPageLength;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addRule
+    /// Adds a conditional format to a column, e.g.
+    /// addRule(2, TRule::above(500, COLOR_RED)). The rules of a column are
+    /// checked in order, the first match colors the cell. The rules are
+    /// evaluated on each print, only if the terminal shows colors.
+    //--------------------------------------------------------------------------
+    void addRule(
+        const size_t    aCol,               ///< Column
+        const TRule&    arRule ) {          ///< Rule
+        if (!mpRules) {
+            mpRules.reset(new TRules);
+        }
+
+        if (mpRules->mRules.size() <= aCol) {
+            mpRules->mRules.resize(aCol + 1);
+        }
+        mpRules->mRules[aCol].push_back(arRule);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::clearRules
+    /// Removes all conditional formats
+    //--------------------------------------------------------------------------
+    void clearRules(void) {
+        mpRules.reset();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setBorder
+    /// Sets the style of the separator lines and column separators for the
+    /// table and its subtables. Subtables added later take the style of
+    /// their parent.
+    //--------------------------------------------------------------------------
+    void setBorder( const EBorder aBorder ) {   ///< Border style
+        mBorder = aBorder;
+
+        for (size_t iRow = 0; iRow < mRows.size(); iRow++) {
+            if (mRows[iRow].mpSubTable != NULL) {
+                mRows[iRow].mpSubTable->setBorder(aBorder);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setBudget
+    /// Limits the memory of the rows, including cells, attributes and
+    /// subtables, to aBytes. When the budget is used up, a new row flushes
+    /// or spills the page, or is dropped with BUDGET_REJECT. BUDGET_TRUNCATE
+    /// cuts the values of new cells to the rest of the budget and drops the
+    /// rows and cells that do not fit even with an empty value. Cells of
+    /// subtables count for the table with the budget. A subtable row is
+    /// never dropped, it is needed for the subtable. 0 turns the budget off.
+    /// The entries of DICT columns count once, a DICT cell as its code.
+    /// Not counted are the cell storage that released rows keep for reuse
+    /// and the padded output copies of the DICT entries.
+    //--------------------------------------------------------------------------
+    void setBudget(
+        const SAP_ULLONG    aBytes,                     ///< Byte budget
+        const EBudget       aPolicy = BUDGET_FLUSH ) {  ///< Overflow policy
+        mBudget       = aBytes;
+        mBudgetPolicy = aPolicy;
+        mRejected     = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getBytes
+    /// Memory held by the rows, the cells and the subtables
+    //--------------------------------------------------------------------------
+    SAP_ULLONG getBytes(void) const {
+        return mBytes;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::getRejected
+    /// Rows and cells dropped by the budget since the budget was set
+    //--------------------------------------------------------------------------
+    SAP_ULLONG getRejected(void) const {
+        return mRejected;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setRing
+    /// Keep only the most recent aCapacity rows, e.g. for a live metric feed.
+    /// When the ring is full, each new row overwrites the oldest one in place
+    /// and reuses its storage, the column widths follow the rows in the ring.
+    /// print() shows the rows from the oldest to the newest. The ring
+    /// replaces the page length flush. Call it before the first row is added,
+    /// 0 turns the ring off.
+    //--------------------------------------------------------------------------
+    void setRing( const size_t aCapacity ) {    ///< Rows kept
+        mRingSize = aCapacity;
+        mRingHead = 0;
+        mRingCols.clear();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setViewport
+    /// Restrict the output to the columns that fit into the given width,
+    /// e.g. the terminal width. The first aFrozen columns are always shown,
+    /// the remaining columns start at column aOffset. Width 0 shows all
+    /// columns. In a viewport MERGE cells do not span hidden columns.
+    //--------------------------------------------------------------------------
+    void setViewport(
+        const TStringSize   aWidth,             ///< Viewport width
+        const size_t        aOffset = 0,        ///< First scrolled column
+        const size_t        aFrozen = 0 ) {     ///< Number of frozen columns
+        mViewWidth  = aWidth;
+        mViewOffset = aOffset;
+        mViewFrozen = aFrozen;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setColor
+    /// Sets the color for output
+    /// @return The old color attribute
+    //--------------------------------------------------------------------------
+    SAP_UINT setColor(const EColor aColor);       ///< New color
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+    inline TAttr getOpAttr(void) {
+        TAttr        lAttr(std::move(mOpAttr));
+
+        mOpAttr = TAttr();
+        return lAttr;
+    }
+
+
+private:
+    //--------------------------------------------------------------------------
+    /// SfCTable::endline
+    /// Trigger the output
+    //--------------------------------------------------------------------------
+    void endline(const SfCTable::EColor aColor);
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::evalColor
+    /// Maps the color to the console attributes without output
+    //--------------------------------------------------------------------------
+    SAP_UINT evalColor(const EColor aColor);      ///< New color
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::appendAttr
+    /// Appends the escape sequence for the attributes to a line
+    //--------------------------------------------------------------------------
+    static void appendAttr(
+        TString&        arLine,             ///< Line to append to
+        const SAP_UINT  aAttr);             ///< New colors and attributes
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::colorAttr
+    /// Console attributes of a color
+    //--------------------------------------------------------------------------
+    static SAP_UINT colorAttr(const EColor aColor);     ///< Color
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::rgbAttr
+    /// Console attributes nearest to a 24 bit color
+    //--------------------------------------------------------------------------
+    static SAP_UINT rgbAttr(const SAP_UINT aRgb);       ///< Color as 0xRRGGBB
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::appendCellColor
+    /// Appends the escape sequence of a cell color for the terminal depth
+    //--------------------------------------------------------------------------
+    static void appendCellColor(
+        TString&        arLine,             ///< Line to append to
+        const SAP_UINT  aColor);            ///< CELL_ATTR or CELL_RGB color
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::detectTermColors
+    /// Colors supported by standard output
+    //--------------------------------------------------------------------------
+    static ETermColors detectTermColors(void);
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::buildPalette
+    /// Precomputes the escape sequences of all attributes for sTermColors
+    //--------------------------------------------------------------------------
+    static void buildPalette(void);
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::readInput
+    /// Waits for terminal input and appends it to sInput.
+    /// @return Number of bytes read, 0 on timeout, -1 on end of file
+    //--------------------------------------------------------------------------
+    static SAP_INT readInput(
+        const SAP_INT   aTimeout);          ///< Milliseconds, -1: infinite
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::takeLine
+    /// Takes the first complete line out of sInput
+    //--------------------------------------------------------------------------
+    static bool takeLine(
+        TString&        arInput ) {         ///< The line without line end
+        size_t  lEnd = sInput.find('\n');
+
+        if (lEnd == TString::npos) {
+            return false;
+        }
+        arInput.assign(sInput, 0, (lEnd > 0 && sInput[lEnd - 1] == '\r') ? lEnd - 1 : lEnd);
+        sInput.erase(0, lEnd + 1);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::takeRest
+    /// Takes the unterminated last line at end of file
+    //--------------------------------------------------------------------------
+    static bool takeRest(
+        TString&        arInput ) {         ///< The line
+        if (sInput.empty()) {
+            return false;
+        }
+        arInput.swap(sInput);
+        sInput.clear();
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::stopAsync
+    /// Write the queued lines and stop the writer thread. At exit the lines
+    /// coalesced but not yet queued are lost, call flush() before.
+    //--------------------------------------------------------------------------
+    static void stopAsync(void) {
+        delete spAsync;
+        spAsync = NULL;
+    }
+
+#ifdef SF_ZLIB
+    //--------------------------------------------------------------------------
+    /// SfCTable::stopZip
+    /// Compress the rest and end the compressed stream of the redirected
+    /// output
+    //--------------------------------------------------------------------------
+    static void stopZip(void) {
+        delete spZip;
+        spZip = NULL;
+    }
+#endif
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::writeOut
+    /// Write a rendered line to the file or to the terminal (NULL), through
+    /// the writer thread if output is asynchronous
+    //--------------------------------------------------------------------------
+    static void writeOut(
+        FILE*           apFile,             ///< Target file, NULL: terminal
+        TString&&       arData,             ///< Rendered output
+        TStats*         apStats = NULL ) {  ///< Table statistics
+        SF_STAT(TStatTimer lTimer(apStats, STAT_NS_IO);)
+        SF_STAT(addStat(apStats, STAT_WRITES, 1);)
+        (void)apStats;
+
+#ifdef SF_ZLIB
+        if (spZip && apFile == spOut) {
+            spZip->write(arData);
+            return;
+        }
+#endif
+        if (spAsync) {
+            spAsync->push(apFile, std::move(arData));
+        }
+        else if (apFile) {
+            fwrite(arData.data(), 1, arData.size(), apFile);
+        }
+        else {
+            cout.write(arData.data(), arData.size());
+            cout.flush();
+        }
+    }
+
+#ifdef SF_TABLE_STATS
+    //==========================================================================
+    /// @class TStatTimer
+    /// Adds the nanoseconds of its lifetime to a counter.
+    //==========================================================================
+    class TStatTimer {
+    private:
+        TStats*         mpStats;        ///< Table statistics, NULL: global only
+        EStat           mStat;          ///< Counter
+        std::chrono::steady_clock::time_point mStart;   ///< Start time
+
+    public:
+        TStatTimer(
+            TStats*         apStats,        ///< Table statistics
+            const EStat     aStat ):        ///< Counter
+            mpStats(apStats),
+            mStat(aStat),
+            mStart(std::chrono::steady_clock::now()) {
+        }
+
+        ~TStatTimer() {
+            addStat(mpStats, mStat, (SAP_ULLONG)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mStart).count());
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addStat
+    /// Counts for a table and for all tables
+    //--------------------------------------------------------------------------
+    static void addStat(
+        TStats*         apStats,            ///< Table statistics, NULL: global only
+        const EStat     aStat,              ///< Counter
+        const SAP_ULLONG aValue ) {         ///< Increment
+        if (apStats != NULL) {
+            apStats->mValue[aStat] += aValue;
+        }
+        sStats[aStat].fetch_add(aValue, std::memory_order_relaxed);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::trackPeak
+    /// Tracks the peak of the memory held by the rows
+    //--------------------------------------------------------------------------
+    void trackPeak(void) {
+        SAP_ULLONG  lPeak = sStats[STAT_PEAK_ROW_BYTES].load(std::memory_order_relaxed);
+
+        if (mStats.mValue[STAT_PEAK_ROW_BYTES] < mBytes) {
+            mStats.mValue[STAT_PEAK_ROW_BYTES] = mBytes;
+        }
+
+        while (lPeak < mBytes &&
+              !sStats[STAT_PEAK_ROW_BYTES].compare_exchange_weak(lPeak, mBytes)) {
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::addBytes
+    /// Accounts the memory of rows and cells, for this table and the tables
+    /// above, since a subtable is released with the row that holds it
+    //--------------------------------------------------------------------------
+    void addBytes( const SAP_LLONG aBytes ) {       ///< Bytes added or released
+        for (SfCTable* lpTable = this; lpTable != NULL; lpTable = lpTable->mpParent) {
+            lpTable->mBytes += aBytes;
+            SF_STAT(lpTable->trackPeak();)
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellBytes
+    /// Memory of a cell, with the value if it does not fit into the string
+    //--------------------------------------------------------------------------
+    static SAP_ULLONG cellBytes( const TCell& arCell ) {   ///< Cell
+        static const size_t lInline = TString().capacity();
+
+        if (!arCell.mBorrowed && arCell.mValue.capacity() > lInline) {
+            return sizeof(TCell) + arCell.mValue.capacity() + 1;
+        }
+        return sizeof(TCell);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::codeBytes
+    /// Memory of the code row of a row
+    //--------------------------------------------------------------------------
+    SAP_ULLONG codeBytes( const TRow& arRow ) const {  ///< Row
+        return (arRow.mCodeRow != DICT_NONE) ? mpDict->stride() * sizeof(SAP_UINT) : 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::rowBytes
+    /// Memory of a row and its cells, the DICT cells count as codes
+    //--------------------------------------------------------------------------
+    SAP_ULLONG rowBytes( const TRow& arRow ) const {   ///< Row
+        SAP_ULLONG  lBytes = sizeof(TRow) + codeBytes(arRow);
+
+        for (size_t iCell = 0; iCell < arRow.mCells.size(); iCell++) {
+            lBytes += cellBytes(arRow.mCells[iCell]);
+        }
+
+        if (arRow.mpSubTable != NULL) {
+            lBytes += arRow.mpSubTable->mBytes;
+        }
+        return lBytes;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::fixDictCols
+    /// Fixes the DICT columns by the header, when the first data row is
+    /// added. Later DICT flags of the header are ignored.
+    //--------------------------------------------------------------------------
+    void fixDictCols(void) {
+        size_t  lCols = mpHeader->mCells.size();
+        size_t  lCell = 0;
+
+        mDictFixed = true;
+
+        for (size_t iCell = 0; iCell < lCols; iCell++) {
+            const TAttr&    lrAttr = mpHeader->mCells[iCell].mCellAttr;
+
+            if (!lrAttr.test(DICT) || lrAttr.test(BOOL) || lrAttr.test(YESNO)) {
+                continue;
+            }
+
+            if (!mpDict) {
+                mpDict.reset(new TDictCols);
+                mpDict->mDictOf.assign(lCols, -1);
+                mpDict->mCellOf.assign(lCols, 0);
+            }
+            mpDict->mDictOf[iCell] = (SAP_INT)mpDict->mDicts.size();
+            mpDict->mDicts.emplace_back();
+        }
+
+        for (size_t iCell = 0; mpDict && iCell < lCols; iCell++) {
+            mpDict->mCellOf[iCell] = (SAP_UINT)((mpDict->mDictOf[iCell] < 0) ? lCell++ : lCell);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellCount
+    /// Number of cells in a row, with the DICT cells
+    //--------------------------------------------------------------------------
+    size_t cellCount( const TRow& arRow ) const {   ///< Row
+        if (arRow.mCodeRow == DICT_NONE) {
+            return arRow.mCells.size();
+        }
+        return mpDict->mCodes[arRow.mCodeRow * mpDict->stride()];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellAt
+    /// Cell of a column, a DICT cell is the cell of its dictionary entry
+    //--------------------------------------------------------------------------
+    TCell& cellAt(
+        TRow&           arRow,                  ///< Row
+        const size_t    iCell ) {               ///< Column, below cellCount
+        if (arRow.mCodeRow == DICT_NONE) {
+            return arRow.mCells[iCell];
+        }
+
+        SAP_INT     lDict = mpDict->dictOf(iCell);
+
+        if (lDict < 0) {
+            return arRow.mCells[mpDict->cellOf(iCell)];
+        }
+        return mpDict->mDicts[lDict].cell(mpDict->codes(arRow.mCodeRow)[1 + lDict]);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellAt
+    /// Cell of a column, read only
+    //--------------------------------------------------------------------------
+    const TCell& cellAt(
+        const TRow&     arRow,                  ///< Row
+        const size_t    iCell ) const {         ///< Column, below cellCount
+        return const_cast<SfCTable*>(this)->cellAt(const_cast<TRow&>(arRow), iCell);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::internCell
+    /// Interns a new cell of a DICT column, which gets the measures and the
+    /// code of its entry.
+    /// @return false if the column is kept in the rows
+    //--------------------------------------------------------------------------
+    bool internCell(
+        TCell&          arCell,                 ///< New cell
+        const size_t    iCell ) {               ///< Column
+        SAP_INT     lDict = mpDict ? mpDict->dictOf(iCell) : -1;
+
+        if (lDict < 0) {
+            return false;
+        }
+        addBytes(mpDict->mDicts[lDict].intern(arCell));
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::storeCell
+    /// Appends a measured cell to a row, an interned cell as its code
+    //--------------------------------------------------------------------------
+    void storeCell(
+        TRow&           arRow,                  ///< Row
+        TCell&&         arCell ) {              ///< Cell, moved into the row
+        if (arRow.mCodeRow == DICT_NONE) {
+            arRow.mCells.emplace_back(std::move(arCell));
+            return;
+        }
+
+        SAP_UINT*   lpCodes = mpDict->codes(arRow.mCodeRow);
+        SAP_INT     lDict   = mpDict->dictOf(lpCodes[0]++);
+
+        if (lDict < 0) {
+            arRow.mCells.emplace_back(std::move(arCell));
+        }
+        else {
+            lpCodes[1 + lDict] = arCell.mCode;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::releaseCodes
+    /// Releases the DICT cells of a row, the row keeps its code row
+    //--------------------------------------------------------------------------
+    void releaseCodes( TRow& arRow ) {          ///< Row
+        if (arRow.mCodeRow == DICT_NONE) {
+            return;
+        }
+
+        SAP_UINT*   lpCodes = mpDict->codes(arRow.mCodeRow);
+
+        for (size_t iDict = 0; iDict < mpDict->mDicts.size(); iDict++) {
+            if (lpCodes[1 + iDict] != DICT_NONE) {
+                addBytes(-(SAP_LLONG)mpDict->mDicts[iDict].release(lpCodes[1 + iDict]));
+                lpCodes[1 + iDict] = DICT_NONE;
+            }
+        }
+        lpCodes[0] = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::resetRow
+    /// Clears a row for reuse and releases its DICT cells and code row
+    //--------------------------------------------------------------------------
+    void resetRow( TRow& arRow ) {              ///< Row
+        if (arRow.mCodeRow != DICT_NONE) {
+            releaseCodes(arRow);
+            mpDict->recycle(arRow.mCodeRow);
+            arRow.mCodeRow = DICT_NONE;
+        }
+        arRow.reset();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::budgetTable
+    /// The nearest table with a byte budget, this table or a superior one
+    //--------------------------------------------------------------------------
+    SfCTable* budgetTable(void) {
+        for (SfCTable* lpTable = this; lpTable != NULL; lpTable = lpTable->mpParent) {
+            if (lpTable->mBudget > 0) {
+                return lpTable;
+            }
+        }
+        return NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::admitCell
+    /// Applies the byte budget to a new data cell before it is measured.
+    /// BUDGET_TRUNCATE cuts the value only while the cell itself fits, a
+    /// truncated value ends on a character boundary. A rejected cell drops
+    /// its whole row, so no partial row is printed and no cell moves into a
+    /// wrong column.
+    /// @return false if the cell is dropped
+    //--------------------------------------------------------------------------
+    bool admitCell( TCell& arCell ) {           ///< New cell
+        SfCTable*   lpBudget = (mRejectRow || mBudget > 0 || mpParent != NULL) ? budgetTable() : NULL;
+
+        if (lpBudget == NULL) {
+            return true;
+        }
+
+        if (mRejectRow) {
+            lpBudget->mRejected++;
+            return false;
+        }
+
+        SAP_ULLONG  lBytes = cellBytes(arCell);
+
+        if (lpBudget->mBytes + lBytes <= lpBudget->mBudget) {
+            return true;
+        }
+
+        SAP_ULLONG  lFree = (lpBudget->mBytes < lpBudget->mBudget) ? lpBudget->mBudget - lpBudget->mBytes : 0;
+
+        if (lpBudget->mBudgetPolicy == BUDGET_REJECT ||
+           (lpBudget->mBudgetPolicy == BUDGET_TRUNCATE && lFree < sizeof(TCell))) {
+            mRejectRow = true;
+            lpBudget->mRejected++;
+            dropRow();
+            return false;
+        }
+
+        if (lpBudget->mBudgetPolicy == BUDGET_TRUNCATE && !arCell.mBorrowed) {
+            size_t      lKeep = (lFree > sizeof(TCell) + 1) ? (size_t)(lFree - sizeof(TCell) - 1) : 0;
+
+            if (lKeep < arCell.mValue.size()) {
+                while (lKeep > 0 && (arCell.mValue[lKeep] & 0xC0) == 0x80) {
+                    lKeep--;
+                }
+                arCell.mValue.resize(lKeep);
+                arCell.mValue.shrink_to_fit();
+            }
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::dropRow
+    /// Releases the current row with the cells added so far, when its next
+    /// cell is rejected. The column widths keep what the cells added. A
+    /// subtable row stays for its subtable, and a ring keeps its rows.
+    //--------------------------------------------------------------------------
+    void dropRow(void) {
+        TRow&   lrRow = mRows.back();
+
+        if (mRingSize > 0 || mpRow != &lrRow || mpRow == mpHeader || lrRow.mpSubTable != NULL) {
+            return;
+        }
+
+        if (mpPrompt == &lrRow) {
+            mpPrompt = NULL;
+        }
+        addBytes(-(SAP_LLONG)rowBytes(lrRow));
+        resetRow(lrRow);
+        mFreeRows.push_back(std::move(lrRow));
+        mRows.pop_back();
+        mpRow = &mRows.back();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::admitRow
+    /// Applies the byte budget to a new row. The budgeted table flushes or
+    /// spills its page, a subtable leaves that to the next row of the
+    /// budgeted table.
+    /// @return false if the row is rejected
+    //--------------------------------------------------------------------------
+    bool admitRow(void) {
+        SfCTable*   lpBudget = (mBudget > 0 || mpParent != NULL) ? budgetTable() : NULL;
+
+        mRejectRow = false;
+
+        if (lpBudget == NULL || lpBudget->mBytes < lpBudget->mBudget) {
+            return true;
+        }
+
+        switch (lpBudget->mBudgetPolicy) {
+        case BUDGET_REJECT:
+        case BUDGET_TRUNCATE:
+            mRejectRow = true;
+            lpBudget->mRejected++;
+            return false;
+
+        case BUDGET_FLUSH:
+            if (lpBudget == this && mRows.size() > 1) {
+                flushPage();
+            }
+            return true;
+
+        case BUDGET_SPILL:
+            if (lpBudget == this && mRows.size() > 1) {
+                spillPage();
+            }
+            return true;
+
+        default:
+            return true;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::statsPtr
+    /// Statistics of the table, NULL without SF_TABLE_STATS
+    //--------------------------------------------------------------------------
+    TStats* statsPtr(void) {
+#ifdef SF_TABLE_STATS
+        return &mStats;
+#else
+        return NULL;
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::evalStats
+    /// Collects the column statistics of the rows added so far. Later rows
+    /// are counted in addCell, as long as fitWidth is active.
+    //--------------------------------------------------------------------------
+    void evalStats(void) {
+        TRows::iterator lIt;
+
+        mColStats.clear();
+
+        for (lIt = mRows.begin(); lIt != mRows.end(); ++lIt) {
+            if (lIt->mRowAttr.test(R_HEADER)) {
+                continue;
+            }
+
+            for (size_t iCell = 0; iCell < cellCount(*lIt); iCell++) {
+                TCell& lrCell = cellAt(*lIt, iCell);
+
+                if (lrCell.mCellAttr.test(MERGE) || mpHeader->mCells[iCell].mCellAttr.test(FIXED)) {
+                    continue;
+                }
+
+                if (mColStats.size() <= iCell) {
+                    mColStats.resize(iCell + 1);
+                }
+                TColStat& lrStat = mColStats[iCell];
+
+                lrStat.add(lrCell.mDispWidth, lrCell.mCellAttr.test(NUMBER));
+                lrStat.mMax = MAX(lrStat.mMax, lrCell.mDispWidth);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printSpace
+    /// Print spaces
+    //--------------------------------------------------------------------------
+    void printSpace(
+        const size_t    aWidth,             ///< number of fill characters
+        const SAP_UC    aChar = ' ') {      ///< the character to fill with
+        mOutput << TString(MIN(aWidth, sMaxRowWidth), aChar);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::lineWidth
+    /// Width to pad the output lines to
+    //--------------------------------------------------------------------------
+    TStringSize lineWidth(void) {
+        if ((mViewWidth > 0) && (mViewWidth <= mAttr.mWidth)) {
+            return mViewWidth - 1;
+        }
+        return mAttr.mWidth;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printText
+    /// Prints a cell value straight from its buffer
+    //--------------------------------------------------------------------------
+    void printText(
+        const SAP_UC*   apValue,            ///< text to print
+        const size_t    aLen,               ///< text length in bytes
+        const bool      aCut = false) {     ///< mark the text as truncated
+        mOutput.write(apValue, aLen);
+        if (aCut) {
+            mOutput << '*';
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::outWidth
+    /// Display width of the pending output line
+    //--------------------------------------------------------------------------
+    TStringSize outWidth(void) {
+        return SfCUtf8::width(mOutput.str());
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::borderStyle
+    /// Characters of a border style
+    //--------------------------------------------------------------------------
+    static const TBorderStyle& borderStyle( const EBorder aBorder ) {   ///< Border style
+        static const TBorderStyle lStyles[BORDER_COUNT] = {
+            { NULL, "-", {
+                { "+", "+", "+" },
+                { "+", "+", "+" },
+                { NULL, NULL, NULL } } },
+            { "\xE2\x94\x82", "\xE2\x94\x80", {
+                { "\xE2\x94\x8C", "\xE2\x94\xAC", "\xE2\x94\x90" },
+                { "\xE2\x94\x9C", "\xE2\x94\xBC", "\xE2\x94\xA4" },
+                { "\xE2\x94\x94", "\xE2\x94\xB4", "\xE2\x94\x98" } } },
+            { " ", "-", {
+                { NULL, NULL, NULL },
+                { " ", " ", " " },
+                { NULL, NULL, NULL } } },
+            { " ", " ", {
+                { NULL, NULL, NULL },
+                { NULL, NULL, NULL },
+                { NULL, NULL, NULL } } }
+        };
+        return lStyles[aBorder < BORDER_COUNT ? aBorder : BORDER_ASCII];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::sepStr
+    /// Column separator of the border style
+    //--------------------------------------------------------------------------
+    const TString& sepStr(void) const {
+        static const TString lSeps[BORDER_COUNT] = {
+            "", "\xE2\x94\x82", " ", " "
+        };
+        return (mBorder == BORDER_ASCII || mBorder >= BORDER_COUNT) ? sSepStr : lSeps[mBorder];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::borderLine
+    /// Separator line for the columns of a row. The lines of a style are
+    /// built once for the column widths and reused until a width changes.
+    //--------------------------------------------------------------------------
+    const TString& borderLine(
+        TRow&           arRow,              ///< Row with the column widths
+        const ELine     aLine ) {           ///< Position of the line
+        TBorderCache&   lrCache = mBorderCache;
+        size_t          lCols   = mViewCols.empty() ? arRow.mCells.size() : mViewCols.size();
+        bool            lValid  = lrCache.mValid && lrCache.mBorder == mBorder &&
+                                  lrCache.mIndent == mIndent && lrCache.mLineWidth == lineWidth() &&
+                                  lrCache.mWidths.size() == lCols;
+
+        for (size_t lCol = 0; lValid && lCol < lCols; lCol++) {
+            size_t iCell = mViewCols.empty() ? lCol : mViewCols[lCol];
+
+            lValid = lrCache.mWidths[lCol] == arRow.mCells[iCell].mCellAttr.mWidth;
+        }
+
+        if (!lValid) {
+            lrCache.mBorder    = mBorder;
+            lrCache.mIndent    = mIndent;
+            lrCache.mLineWidth = lineWidth();
+            lrCache.mWidths.resize(lCols);
+
+            for (size_t lCol = 0; lCol < lCols; lCol++) {
+                size_t iCell = mViewCols.empty() ? lCol : mViewCols[lCol];
+
+                lrCache.mWidths[lCol] = arRow.mCells[iCell].mCellAttr.mWidth;
+            }
+
+            for (size_t iLine = 0; iLine < LINE_COUNT; iLine++) {
+                buildLine(borderStyle(mBorder), (ELine)iLine, lrCache.mLines[iLine]);
+            }
+            lrCache.mValid = true;
+        }
+        return lrCache.mLines[aLine];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::buildLine
+    /// Composes a separator line from the joins and the column widths of
+    /// the border cache. The line is padded to the line width of the table.
+    //--------------------------------------------------------------------------
+    void buildLine(
+        const TBorderStyle& arStyle,        ///< Border style
+        const ELine         aLine,          ///< Position of the line
+        TString&            arLine ) {      ///< Composed line
+        const SAP_UC* const* lpJoin = arStyle.mJoin[aLine];
+        const vector<TStringSize>& lrWidths = mBorderCache.mWidths;
+        TStringSize     lFillLen = (TStringSize)strlen(arStyle.mFill);
+        TStringSize     lWidth   = (TStringSize)(mIndent < (SAP_INT)sMaxRowWidth ? mIndent : sMaxRowWidth);
+        TStringSize     lPad;
+
+        arLine.clear();
+
+        if (lpJoin[0] == NULL) {
+            return;
+        }
+
+        for (size_t lCol = 0; lCol < lrWidths.size(); lCol++) {
+            arLine += (lCol == 0) ? lpJoin[0] : lpJoin[1];
+
+            for (TStringSize iChar = 0; iChar < lrWidths[lCol]; iChar++) {
+                arLine.append(arStyle.mFill, lFillLen);
+            }
+            lWidth += 1 + lrWidths[lCol];
+        }
+
+        for (lPad = lWidth; lPad < lineWidth(); lPad++) {
+            arLine.append(arStyle.mFill, lFillLen);
+        }
+        arLine += lpJoin[2];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printLine
+    /// Prints a separator line.
+    //--------------------------------------------------------------------------
+    void printLine(
+        TRow&           arRow,                      ///< Row to print
+        const EColor    aColor = COLOR_BRIGHT,      ///< Row color
+        const ELine     aLine  = LINE_MID ) {       ///< Position of the line
+        const TString&  lrLine = borderLine(arRow, aLine);
+
+        if (!lrLine.empty()) {
+            mOutput.write(lrLine.data(), lrLine.size());
+            endline(aColor);
+        }
+        else {
+            mOutput.str("");
+        }
+
+        if (mAttr.mColor == COLOR_TOGGLE) {
+            mAttr.mColor = COLOR_TOGGLE_DARK;
+        }
+    }
+
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printHeader
+    /// Prints the header of a table.
+    //--------------------------------------------------------------------------
+    void printHeader(void) {
+        if (mpHeader->mRowAttr.test(R_INVISIBLE)) {
+            return;
+        }
+
+        printSpace(mIndent);
+        printLine(*mpHeader, COLOR_BRIGHT, LINE_TOP);
+
+        printRow(*mpHeader, COLOR_BRIGHT);
+
+        printSpace(mIndent);
+        printLine(*mpHeader, COLOR_BRIGHT);
+    }
+
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printBottom
+    /// Closes a table with a visible header by the bottom line of the style
+    //--------------------------------------------------------------------------
+    void printBottom( const EPrintOption aOption ) {    ///< Print option
+        if (aOption == PRINT_HEADER || mpHeader->mRowAttr.test(R_INVISIBLE)) {
+            return;
+        }
+        mOutput.str("");
+        printSpace(mIndent);
+        printLine(*mpHeader, COLOR_BRIGHT, LINE_BOTTOM);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printCell
+    /// Pads, truncates and aligns a cell value within its column
+    //--------------------------------------------------------------------------
+    void printCell(
+        TRow&           arRow,              ///< Row of the cell
+        TCell&          arCell,             ///< Cell to print
+        const size_t    iCell,              ///< Column of the cell
+        const SAP_UC*   apValue,            ///< Value from TCell::getValue
+        TStringSize     aLen,               ///< Value length in bytes
+        TStringSize     aSize,              ///< Value display width
+        size_t          aWidth ) {          ///< Column width
+        size_t  lFill;
+        bool    lCut = false;
+
+        //----------------------------------------------------------------------
+        // Compute the fill space and the printable value.
+        //----------------------------------------------------------------------
+        if (aWidth >= aSize) {
+            lFill = aWidth - aSize;
+        }
+        else {
+            aLen  = SfCUtf8::cut(apValue, aLen, aWidth - 1, aSize);
+            lFill = aWidth - 1 - aSize;
+            lCut  = true;
+        }
+
+        TAttr&  lrAttr = arCell.mCellAttr;
+        bool    lRight = lrAttr.test(RIGHT) ||
+           (lrAttr.test(NUMBER) && !arRow.mRowAttr.test(R_HEADER) && !lrAttr.test(LEFT));
+
+        if (arCell.mCode != DICT_NONE && !lCut && aLen == arCell.size()) {
+            // dictionary entry, padded once per column width
+            mOutput << mpDict->mDicts[mpDict->dictOf(iCell)].padded(arCell.mCode, aSize + lFill, lRight);
+        }
+        else if (lRight) {
+            // right align for numbers
+            printSpace(lFill);
+            printText(apValue, aLen, lCut);
         }
         else {
+            printText(apValue, aLen, lCut);
+            printSpace(lFill);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::evalRules
+    /// Evaluates the rules into the cell colors, one pass per column. Each
+    /// value is parsed once per column, whatever the number of its rules.
+    //--------------------------------------------------------------------------
+    void evalRules(void) {
+        TRules&     lrRules = *mpRules;
+        size_t      lCols   = lrRules.mRules.size();
+        SAP_UINT    lRows   = 0;
+        TString     lText;
+
+        for (TRows::iterator lIt = mRows.begin(); lIt != mRows.end(); ++lIt) {
+            lIt->mColorRow = lRows++;
+        }
+        lrRules.mCols = lCols;
+        lrRules.mColors.assign(lRows * lCols, 0);
+
+        for (size_t iCol = 0; iCol < lCols; iCol++) {
+            vector<TRule>&  lrColRules = lrRules.mRules[iCol];
+
+            if (lrColRules.empty()) {
+                continue;
+            }
+
+            for (TRows::iterator lIt = mRows.begin(); lIt != mRows.end(); ++lIt) {
+                if (iCol >= cellCount(*lIt) || lIt->mRowAttr.test(R_HEADER)) {
+                    continue;
+                }
+
+                TCell&      lrCell  = cellAt(*lIt, iCol);
+                SAP_UINT&   lrColor = lrRules.mColors[lIt->mColorRow * lCols + iCol];
+                SAP_DOUBLE  lValue  = 0;
+                bool        lNumber = cellValue(lrCell, lValue);
+
+                for (size_t iRule = 0; iRule < lrColRules.size() && lrColor == 0; iRule++) {
+                    TRule&  lrRule = lrColRules[iRule];
+
+                    switch (lrRule.mType) {
+                    case TRule::RULE_ABOVE:
+                        if (lNumber && lValue > lrRule.mLow) {
+                            lrColor = CELL_ATTR | colorAttr(lrRule.mColor);
+                        }
+                        break;
+
+                    case TRule::RULE_BELOW:
+                        if (lNumber && lValue < lrRule.mLow) {
+                            lrColor = CELL_ATTR | colorAttr(lrRule.mColor);
+                        }
+                        break;
+
+                    case TRule::RULE_RANGE:
+                        if (lNumber && lValue >= lrRule.mLow && lValue <= lrRule.mHigh) {
+                            lrColor = CELL_ATTR | colorAttr(lrRule.mColor);
+                        }
+                        break;
+
+                    case TRule::RULE_MATCH:
+                        lText.assign(lrCell.data(), lrCell.size());
+
+                        if (std::regex_search(lText, *lrRule.mpRegex)) {
+                            lrColor = CELL_ATTR | colorAttr(lrRule.mColor);
+                        }
+                        break;
+
+                    case TRule::RULE_GRADIENT:
+                        if (lNumber) {
+                            lrColor = CELL_RGB | heatColor(lrRule.mLow, lrRule.mHigh, lValue);
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::heatColor
+    /// Color of a value on the scale green - yellow - red as 0xRRGGBB
+    //--------------------------------------------------------------------------
+    static SAP_UINT heatColor(
+        const SAP_DOUBLE    aLow,           ///< Value shown green
+        const SAP_DOUBLE    aHigh,          ///< Value shown red
+        const SAP_DOUBLE    aValue ) {      ///< Value
+        SAP_DOUBLE  lPos = (aHigh > aLow) ? (aValue - aLow) / (aHigh - aLow) : 0;
+
+        lPos = (lPos < 0) ? 0 : (lPos > 1) ? 1 : lPos;
+
+        SAP_UINT    lRed   = (SAP_UINT)(255 * ((lPos < 0.5) ? 2 * lPos : 1));
+        SAP_UINT    lGreen = (SAP_UINT)(255 * ((lPos > 0.5) ? 2 * (1 - lPos) : 1));
+
+        return (lRed << 16) | (lGreen << 8);
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::cellColor
+    /// Evaluated color of a cell, 0 if it has none. A rule color comes first,
+    /// then the own color of a HIGHLIGHT cell.
+    //--------------------------------------------------------------------------
+    SAP_UINT cellColor(
+        const TRow&     arRow,              ///< Row of the cell
+        const size_t    iCell ) const {     ///< Column
+        if (arRow.mRowAttr.test(R_HEADER)) {
+            return 0;
+        }
+
+        if (mpRules) {
+            size_t  lIndex = arRow.mColorRow * mpRules->mCols + iCell;
+
+            if (iCell < mpRules->mCols && lIndex < mpRules->mColors.size() && mpRules->mColors[lIndex] != 0) {
+                return mpRules->mColors[lIndex];
+            }
+        }
+
+        if (iCell < cellCount(arRow) && cellAt(arRow, iCell).mCellAttr.test(HIGHLIGHT) &&
+            cellAt(arRow, iCell).mCellAttr.mColor != COLOR_NONE && sTermColors != TERM_COLORS_NONE) {
+            return CELL_ATTR | colorAttr(cellAt(arRow, iCell).mCellAttr.mColor);
+        }
+        return 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::markColor
+    /// Marks a color change at the current position of the line
+    //--------------------------------------------------------------------------
+    void markColor( const SAP_UINT aColor ) {   ///< Cell color, 0: line color
+        if (!mpRules) {
+            mpRules.reset(new TRules);
+        }
+        mpRules->mSpans.push_back(std::make_pair((size_t)mOutput.tellp(), aColor));
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printCells
+    /// Prints all cells of a row
+    /// @return true, if some cell has data left for a continuation line
+    //--------------------------------------------------------------------------
+    bool printCells( TRow& arRow ) {            ///< Row to print
+        TCells::iterator lHdrIt = mpHeader->mCells.begin();
+        size_t           lCells  = cellCount(arRow);
+        size_t           iCell   = 0;
+        const SAP_UC*    lpValue;
+        TStringSize      lLen;
+        bool             lRemain = false;
+        bool             lHasRes = false;
+
+        //----------------------------------------------------------------------
+        // Process the cells of the row.
+        //----------------------------------------------------------------------
+        while (lHdrIt != mpHeader->mCells.end() && iCell < lCells) {
+            TCell&    lrCurCell = cellAt(arRow, iCell);
+            TCell&    lrHdrCell = (*lHdrIt);
+            size_t    lWidth = lrHdrCell.mCellAttr.mWidth;
+            size_t    lSize = 0;
+
             //------------------------------------------------------------------
-            // Output is table data.
+            // Fetch the cell contents.
+            //------------------------------------------------------------------
+            lpValue = lrCurCell.getValue(arRow.mContinue, lHasRes, lSize, lLen,
+                        (lrHdrCell.mCellAttr.test(WRAP) && !lrCurCell.mCellAttr.test(MERGE)) ? lWidth : 0);
+            lRemain = lRemain || lHasRes;
+
+            if ((lWidth < lSize) && lrCurCell.mCellAttr.test(MERGE)) {
+                //--------------------------------------------------------------
+                // Check how many colums the MERGE cell spans.
+                //--------------------------------------------------------------
+                lHdrIt++;
+                while (lHdrIt != mpHeader->mCells.end()) {
+                    lWidth += lHdrIt->mCellAttr.mWidth + 1;
+                    if (lWidth >= lSize) {
+                        break;
+                    }
+                    lHdrIt++;
+                }
+
+                if ((lWidth < lSize) && (lHdrIt == mpHeader->mCells.end())) {
+                    //----------------------------------------------------------
+                    // Use everything that is lelft...
+                    //----------------------------------------------------------
+                    lWidth = mAttr.mWidth - outWidth();
+                }
+            }
+
+            SAP_UINT lColor = cellColor(arRow, iCell);
+
+            if (lColor != 0) {
+                markColor(lColor);
+                printCell(arRow, lrCurCell, iCell, lpValue, lLen, lSize, lWidth);
+                markColor(0);
+            }
+            else {
+                printCell(arRow, lrCurCell, iCell, lpValue, lLen, lSize, lWidth);
+            }
+
+            //------------------------------------------------------------------
+            // Advance to the next column.
+            //------------------------------------------------------------------
+            if (lHdrIt != mpHeader->mCells.end()) {
+                lHdrIt++;
+            }
+            
+            if (iCell < lCells) {
+                iCell++;
+            }
+            //------------------------------------------------------------------
+            // Emit a seprator if there is somethiing left.
             //------------------------------------------------------------------
-            size_t    iCell = lrRow.mCells.size();
+            if ((lHdrIt != mpHeader->mCells.end()) && (iCell < lCells)) {
+                mOutput << sepStr();
+            }
+        }
+        return lRemain;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printViewCells
+    /// Prints the cells of a row, which are visible in the viewport
+    /// @return true, if some cell has data left for a continuation line
+    //--------------------------------------------------------------------------
+    bool printViewCells( TRow& arRow ) {        ///< Row to print
+        const SAP_UC*    lpValue;
+        TStringSize      lLen;
+        TStringSize      lSize;
+        bool             lRemain = false;
+        bool             lHasRes = false;
+
+        for (size_t lCol = 0; lCol < mViewCols.size(); lCol++) {
+            size_t  iCell = mViewCols[lCol];
+
+            if (iCell >= cellCount(arRow)) {
+                break;
+            }
+
+            TCell&  lrCurCell = cellAt(arRow, iCell);
+            TAttr&  lrHdrAttr = mpHeader->mCells[iCell].mCellAttr;
+
+            lpValue = lrCurCell.getValue(arRow.mContinue, lHasRes, lSize, lLen,
+                        lrHdrAttr.test(WRAP) ? lrHdrAttr.mWidth : 0);
+            lRemain = lRemain || lHasRes;
+
+            SAP_UINT lColor = cellColor(arRow, iCell);
+
+            if (lColor != 0) {
+                markColor(lColor);
+                printCell(arRow, lrCurCell, iCell, lpValue, lLen, lSize, lrHdrAttr.mWidth);
+                markColor(0);
+            }
+            else {
+                printCell(arRow, lrCurCell, iCell, lpValue, lLen, lSize, lrHdrAttr.mWidth);
+            }
+
+            if ((lCol + 1 < mViewCols.size()) && (mViewCols[lCol + 1] < cellCount(arRow))) {
+                mOutput << sepStr();
+            }
+        }
+        return lRemain;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Distributes a budget over columns, proportional to their demand.
+    //--------------------------------------------------------------------------
+    static void growWidth(
+        vector<TStringSize>&        arWidth,    ///< widths to grow
+        const vector<TStringSize>&  arLimit,    ///< upper limits
+        TStringSize                 aBudget ) { ///< columns to distribute
+        SAP_ULLONG  lDemand = 0;
+        size_t      lCols   = arWidth.size();
+
+        for (size_t lCol = 0; lCol < lCols; lCol++) {
+            lDemand += arLimit[lCol] - arWidth[lCol];
+        }
+
+        if (lDemand == 0) {
+            return;
+        }
+
+        TStringSize lLeft = aBudget;
+
+        for (size_t lCol = 0; lCol < lCols; lCol++) {
+            TStringSize lAdd = (TStringSize)((SAP_ULLONG)(arLimit[lCol] - arWidth[lCol]) * aBudget / lDemand);
+
+            arWidth[lCol] += lAdd;
+            lLeft         -= lAdd;
+        }
+
+        for (size_t lCol = 0; lCol < lCols && lLeft > 0; lCol++) {
+            if (arWidth[lCol] < arLimit[lCol]) {
+                arWidth[lCol]++;
+                lLeft--;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Solves the column widths for mFitWidth from the column statistics.
+    /// The cells are not visited, the cost is linear in the number of columns.
+    //--------------------------------------------------------------------------
+    void evalFit(void) {
+        size_t      lCols = mpHeader->mCells.size();
+        TStringSize lFrame = mIndent + 1 + lCols;
+
+        if (mFitWidth == 0 || lCols == 0 || mFitWidth <= lFrame) {
+            return;
+        }
+
+        TStringSize          lAvail = mFitWidth - lFrame;
+        vector<TStringSize>  lMin(lCols);
+        vector<TStringSize>  lWant(lCols);
+        vector<TStringSize>  lMax(lCols);
+        SAP_ULLONG           lSumMin  = 0;
+        SAP_ULLONG           lSumWant = 0;
+        SAP_ULLONG           lSumMax  = 0;
+
+        mColStats.resize(lCols);
+
+        for (size_t lCol = 0; lCol < lCols; lCol++) {
+            TCell&      lrHdr  = mpHeader->mCells[lCol];
+            TColStat&   lrStat = mColStats[lCol];
+            TStringSize lLabel = mpHeader->mRowAttr.test(R_INVISIBLE) ? 0 : lrHdr.mDispWidth;
+
+            if (lrHdr.mCellAttr.test(FIXED)) {
+                lMin[lCol] = lWant[lCol] = lMax[lCol] = lrHdr.mCellAttr.mWidth;
+            }
+            else {
+                lMax[lCol]  = MIN(sMaxColWidth, MAX(sMinColWidth, MAX(lrStat.mMax, lLabel)));
+                lWant[lCol] = MIN(lMax[lCol], MAX(sMinColWidth, MAX(lrStat.quantile(95), lLabel)));
+                lMin[lCol]  = (lrStat.mNumbers == lrStat.mCount && lrStat.mCount > 0) ? 
+                                lMax[lCol] : MIN(lWant[lCol], MAX(sMinColWidth, lLabel));
+            }
+            lSumMin  += lMin[lCol];
+            lSumWant += lWant[lCol];
+            lSumMax  += lMax[lCol];
+        }
+
+        //----------------------------------------------------------------------
+        // Start from the tightest layout that fits and grow towards the
+        // widest values.
+        //----------------------------------------------------------------------
+        vector<TStringSize> lWidth;
+
+        if (lSumMax <= lAvail) {
+            lWidth = lMax;
+        }
+        else if (lSumWant <= lAvail) {
+            lWidth = lWant;
+            growWidth(lWidth, lMax, (TStringSize)(lAvail - lSumWant));
+        }
+        else {
+            lWidth = lMin;
+            if (lSumMin < lAvail) {
+                growWidth(lWidth, lWant, (TStringSize)(lAvail - lSumMin));
+            }
+        }
+
+        //----------------------------------------------------------------------
+        // Apply the widths. Text columns, which are too small now, wrap.
+        //----------------------------------------------------------------------
+        for (size_t lCol = 0; lCol < lCols; lCol++) {
+            TCell&      lrHdr  = mpHeader->mCells[lCol];
+            TColStat&   lrStat = mColStats[lCol];
+
+            if (lrHdr.mCellAttr.test(FIXED)) {
+                continue;
+            }
+            lrHdr.mCellAttr.mWidth = lWidth[lCol];
+
+            if (lWidth[lCol] < lMax[lCol] && lrStat.mNumbers < lrStat.mCount) {
+                if (!lrHdr.mCellAttr.test(WRAP)) {
+                    lrHdr.mCellAttr.set(WRAP);
+                    lrStat.mWrapped = true;
+                }
+            }
+            else if (lrStat.mWrapped) {
+                lrHdr.mCellAttr.reset(WRAP);
+                lrStat.mWrapped = false;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Evaluates the columns visible in the viewport.
+    /// Only the visible columns are visited, so the cost does not depend on
+    /// the number of columns in the table.
+    //--------------------------------------------------------------------------
+    void evalView(void) {
+        size_t      lCols  = mpHeader->mCells.size();
+        TStringSize lWidth = mIndent + 1;
+
+        mViewCols.clear();
+        if (mViewWidth == 0) {
+            return;
+        }
+
+        for (size_t lCol = 0; lCol < lCols; lCol++) {
+            if (lCol == mViewFrozen) {
+                lCol = MAX(mViewOffset, mViewFrozen);
+                if (lCol >= lCols) {
+                    break;
+                }
+            }
+
+            TStringSize lColWidth = mpHeader->mCells[lCol].mCellAttr.mWidth + 1;
+
+            if ((lWidth + lColWidth > mViewWidth) && !mViewCols.empty()) {
+                break;
+            }
+            mViewCols.push_back(lCol);
+            lWidth += lColWidth;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printRowLine
+    /// Prints the cells of one line of a row
+    /// @return true if the row continues on the next line
+    //--------------------------------------------------------------------------
+    bool printRowLine(
+        TRow&           arRow,                  ///< Row to print
+        const EColor    aColor ) {              ///< Row color
+        bool lRemain = false;
+
+        mOutput << (arRow.mRowAttr.test(R_MESSAGE) ? " " : sepStr());
+
+        if (mViewCols.empty()) {
+            lRemain = printCells(arRow);
+        }
+        else {
+            lRemain = printViewCells(arRow);
+        }
+
+        TStringSize lOutWidth = outWidth();
+        if (lineWidth() > lOutWidth) {
+            printSpace(lineWidth() - lOutWidth);
+        }
+        mOutput << (arRow.mRowAttr.test(R_MESSAGE) ? " " : sepStr());
+
+        endline(aColor);
+        return lRemain;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printRowHead
+    /// Prints the first line of a row. A subtable row is not printed but
+    /// returns the subtable, arMore tells that a multi-line row continues.
+    //--------------------------------------------------------------------------
+    SfCTable* printRowHead(
+        TRow&           arRow,                  ///< Row to print
+        const EColor    aColor,                 ///< Row color
+        bool&           arMore ) {              ///< Row has more lines
+        arMore = false;
+
+        if (arRow.mRowAttr.test(R_LINE)) {
+            printSpace(mIndent);
+            printLine(*mpHeader);
+            return NULL;
+        }
+
+        if (arRow.mRowAttr.test(R_INVISIBLE)) {
+            return NULL;
+        }
+        printSpace(mIndent);
+
+        if (arRow.mRowAttr.test(R_PROMPT) ||
+            arRow.mRowAttr.test(R_ACKNOWLEDGE)) {
+            mpPrompt = &arRow;
+            return NULL;
+        }
+
+        if (arRow.mRowAttr.test(R_SUBTABLE)) {
+            if ((mViewWidth > 0) && (arRow.mpSubTable->mViewWidth == 0)) {
+                arRow.mpSubTable->setViewport(mViewWidth);
+            }
+            return arRow.mpSubTable;
+        }
+
+        arMore = printRowLine(arRow, aColor);
+        arRow.mContinue = arMore;
+        return NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printRow
+    /// Prints a row of a table
+    //--------------------------------------------------------------------------
+    void printRow(
+        TRow&           arRow,                  ///< Row to print
+        const EColor    aColor = COLOR_NONE ) { ///< Row color
+        bool        lMore;
+        SfCTable*   lpSubTable = printRowHead(arRow, aColor, lMore);
+
+        if (lpSubTable != NULL && openNode(*lpSubTable, true) != NULL) {
+            lpSubTable->print(mPrintOption);
+        }
+
+        while (lMore) {
+            printSpace(mIndent);
+            lMore = printRowLine(arRow, COLOR_SAME);
+        }
+        arRow.mContinue = false;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::rowAt
+    /// Row in print order. In ring mode the data rows start at the oldest
+    /// slot.
+    //--------------------------------------------------------------------------
+    TRow& rowAt( size_t aRow ) {                ///< Row number, 0: header
+        if (aRow == 0 || mRingHead == 0) {
+            return mRows[aRow];
+        }
+        return mRows[1 + (mRingHead + aRow - 1) % (mRows.size() - 1)];
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::ringRow
+    /// Overwrites the oldest row of a full ring. The slot keeps its cell
+    /// storage, the column widths of the dropped row are uncounted.
+    //--------------------------------------------------------------------------
+    void ringRow( const TAttr& arAttr ) {       ///< Row attributes
+        TRow&   lrRow = mRows[1 + mRingHead];
 
-            if (mpHeader->mCells.size() <= iCell) {
-                mpHeader->mCells.resize(iCell + 1);
+        SF_STAT(addStat(&mStats, STAT_ROWS, 1);)
+        addBytes((SAP_LLONG)(sizeof(TRow) + codeBytes(lrRow)) - (SAP_LLONG)rowBytes(lrRow));
+
+        for (size_t iCell = 0; iCell < cellCount(lrRow) && iCell < mRingCols.size(); iCell++) {
+            TCell&  lrCell = cellAt(lrRow, iCell);
+            TAttr&  lrHdrAttr = mpHeader->mCells[iCell].mCellAttr;
+
+            if (lrCell.mCellAttr.test(MERGE) || lrHdrAttr.test(FIXED)) {
+                continue;
             }
+            lrHdrAttr.mWidth = mRingCols[iCell].drop(MIN(sMaxColWidth, lrCell.mDispWidth));
+        }
 
-            TCell&    lrHdr = mpHeader->mCells[iCell];
+        releaseCodes(lrRow);
+        lrRow.reset();
+        lrRow.mpHeader  = mpHeader;
+        lrRow.mRowAttr  = arAttr;
+        lrRow.mRowAttr |= mAttr.mFlags;
 
-            //------------------------------------------------------------------
-            // Merge cell flags and header flags.
-            //------------------------------------------------------------------
-            arCell.mCellAttr.mFlags |= lrHdr.mCellAttr.mFlags;
+        if (lrRow.mRowAttr.test(R_PROMPT) || lrRow.mRowAttr.test(R_ACKNOWLEDGE) || mpPrompt == &lrRow) {
+            mpPrompt = NULL;
+        }
+        mpRow     = &lrRow;
+        mRingHead = (mRingHead + 1) % mRingSize;
+    }
 
-            //------------------------------------------------------------------
-            // Convert boolean cell values.
-            //------------------------------------------------------------------
-            if (arCell.mCellAttr.test(BOOL)) {
-                arCell.mValue = (arCell.mValue != "0") ? "true" : "false";
+    //--------------------------------------------------------------------------
+    /// SfCTable::flushPage
+    /// Prints a full page and releases its rows, including their subtables.
+    /// The header row and the column widths stay for the next page. The
+    /// released rows keep their cell storage and are reused by row(), so a
+    /// long dump runs in the memory of one page. The page is printed in one
+    /// pass with the header on top. Pointers to subtables of the page, as
+    /// returned by subTable, are invalid after the flush.
+    //--------------------------------------------------------------------------
+    void flushPage(void) {
+        print();
+        SF_STAT(addStat(&mStats, STAT_FLUSHES, 1);)
+        releasePage();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::releasePage
+    /// Releases the data rows of a printed or spilled page for reuse
+    //--------------------------------------------------------------------------
+    void releasePage(void) {
+        while (mRows.size() > 1) {
+            addBytes(-(SAP_LLONG)rowBytes(mRows.back()));
+            resetRow(mRows.back());
+            mFreeRows.push_back(std::move(mRows.back()));
+            mRows.pop_back();
+        }
+        mpPrompt = NULL;
+        mpRow    = mpHeader;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::spillPage
+    /// Moves the data rows of the page to a temporary file, print() shows
+    /// them before the rows in memory. A row is stored as the row flags, the
+    /// row color and the cell count, followed by its cells, each as flags,
+    /// color, width, value length and value, all counts as SAP_UINT in the
+    /// byte order of the process. A page with subtables or prompts cannot
+    /// be stored and is flushed, and so is a page the file does not take.
+    //--------------------------------------------------------------------------
+    void spillPage(void) {
+        TString     lRecord;
+
+        for (size_t iRow = 1; iRow < mRows.size(); iRow++) {
+            if (mRows[iRow].mRowAttr.test(R_SUBTABLE) || mRows[iRow].mRowAttr.test(R_PROMPT) ||
+                mRows[iRow].mRowAttr.test(R_ACKNOWLEDGE)) {
+                flushPage();
+                return;
             }
-            else if (arCell.mCellAttr.test(YESNO)) {
-                arCell.mValue = (arCell.mValue != "0") ? "yes" : "no";
+        }
+
+        if (mpSpill == NULL && (mpSpill = tmpfile()) == NULL) {
+            flushPage();
+            return;
+        }
+
+        for (size_t iRow = 1; iRow < mRows.size(); iRow++) {
+            TRow&       lrRow = mRows[iRow];
+            SAP_UINT    lHead[3] = { lrRow.mRowAttr.mFlags, (SAP_UINT)lrRow.mRowAttr.mColor, (SAP_UINT)cellCount(lrRow) };
+
+            lRecord.append((const SAP_UC*)lHead, sizeof(lHead));
+
+            for (size_t iCell = 0; iCell < cellCount(lrRow); iCell++) {
+                TCell&      lrCell = cellAt(lrRow, iCell);
+                SAP_UINT    lCell[4] = { lrCell.mCellAttr.mFlags, (SAP_UINT)lrCell.mCellAttr.mColor,
+                                         (SAP_UINT)lrCell.mCellAttr.mWidth, (SAP_UINT)lrCell.size() };
+
+                lRecord.append((const SAP_UC*)lCell, sizeof(lCell));
+                lRecord.append(lrCell.data(), lrCell.size());
+            }
+        }
+        if (fwrite(lRecord.data(), 1, lRecord.size(), mpSpill) != lRecord.size()) {
+            flushPage();
+            return;
+        }
+        mSpillRows += mRows.size() - 1;
+        SF_STAT(addStat(&mStats, STAT_FLUSHES, 1);)
+        releasePage();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::loadRow
+    /// Reads a spilled row, see spillPage. DICT cells are interned again.
+    /// @return false at the end of the file
+    //--------------------------------------------------------------------------
+    bool loadRow(
+        FILE*           apFile,                 ///< Spill file
+        TRow&           arRow ) {               ///< Row to fill
+        SAP_UINT    lHead[3];
+
+        if (fread(lHead, sizeof(lHead), 1, apFile) != 1) {
+            return false;
+        }
+        arRow.mpHeader = mpHeader;
+        arRow.mRowAttr = TAttr(lHead[0], (EColor)lHead[1]);
+        arRow.mCells.reserve(lHead[2]);
+
+        if (mpDict) {
+            arRow.mCodeRow = mpDict->alloc();
+        }
+
+        for (SAP_UINT iCell = 0; iCell < lHead[2]; iCell++) {
+            SAP_UINT    lCell[4];
+            TString     lValue;
+
+            if (fread(lCell, sizeof(lCell), 1, apFile) != 1) {
+                return false;
+            }
+            lValue.resize(lCell[3]);
+
+            if (lCell[3] > 0 && fread(&lValue[0], lCell[3], 1, apFile) != 1) {
+                return false;
+            }
+            TCell   lLoaded(std::move(lValue), TAttr(lCell[0], (EColor)lCell[1], lCell[2]));
+
+            if (!internCell(lLoaded, iCell)) {
+                lLoaded.measure();
+            }
+            storeCell(arRow, std::move(lLoaded));
+        }
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printSpill
+    /// Prints the spilled rows in blocks and closes the spill file. The rows
+    /// in memory are set aside meanwhile, the header keeps the widths. The
+    /// tail of a failed write is not read.
+    //--------------------------------------------------------------------------
+    void printSpill( EPrintOption aOption ) {   ///< Print option
+        const size_t    lBlock  = 1024;
+        FILE*           lpSpill = mpSpill;
+        size_t          lLeft   = mSpillRows;
+        TRows           lRows;
+        bool            lMore   = true;
+
+        mpSpill    = NULL;
+        mSpillRows = 0;
+
+        for (size_t iRow = 1; iRow < mRows.size(); iRow++) {
+            lRows.push_back(std::move(mRows[iRow]));
+        }
+        mRows.resize(1);
+        rewind(lpSpill);
+
+        while (lMore) {
+            while (mRows.size() <= lBlock) {
+                mRows.emplace_back();
+
+                if (lLeft-- == 0 || !loadRow(lpSpill, mRows.back())) {
+                    resetRow(mRows.back());
+                    mRows.pop_back();
+                    lMore = false;
+                    break;
+                }
+            }
+
+            if (mRows.size() > 1) {
+                TCursor lCursor(*this, aOption);
+
+                lCursor.step();
+                aOption = PRINT_BODY;
+            }
+
+            while (mRows.size() > 1) {
+                resetRow(mRows.back());
+                mRows.pop_back();
+            }
+        }
+        fclose(lpSpill);
+
+        for (size_t iRow = 0; iRow < lRows.size(); iRow++) {
+            mRows.push_back(std::move(lRows[iRow]));
+        }
+        mpPrompt = NULL;
+        mpRow    = &mRows.back();
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::openNode
+    /// Prepares a subtable for printing. In tree mode a marker line shows
+    /// whether the subtable is expanded. A lazy subtable is filled by its
+    /// callback when it is printed expanded for the first time.
+    /// @return The subtable to print, NULL if it is collapsed
+    //--------------------------------------------------------------------------
+    SfCTable* openNode(
+        SfCTable&       arSubTable,             ///< Subtable of a row
+        const bool      aMark ) {               ///< Print the tree marker
+        if (mTree && aMark) {
+            mOutput.str("");
+            printSpace(arSubTable.mIndent);
+            mOutput << (arSubTable.mExpanded ? "[-]" : "[+]");
+            endline(COLOR_NONE);
+        }
+
+        if (!arSubTable.mExpanded) {
+            return NULL;
+        }
+
+        if (arSubTable.mExpand) {
+            TExpand lExpand;
+
+            lExpand.swap(arSubTable.mExpand);
+            lExpand(arSubTable);
+        }
+        return &arSubTable;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printStart
+    /// Prints the head line and evaluates the layout for a print
+    //--------------------------------------------------------------------------
+    void printStart( EPrintOption aOption ) {   ///< Print option
+        mPrintOption = aOption;
+
+        //----------------------------------------------------------------------
+        // Print the table head line.
+        //----------------------------------------------------------------------
+        if (aOption != PRINT_BODY && mHeadLine != "") {
+            printSpace(mIndent);
+            mOutput << mHeadLine;
+            endline(mAttr.mColor);
+        }
+
+        SF_STAT(TStatTimer lTimer(&mStats, STAT_NS_WIDTH);)
+
+        if (mpLayout) {
+            mpLayout->apply(*mpHeader);
+        }
+        evalFit();
+        evalWidth();
+        evalView();
+
+        if (mpRules) {
+            mpRules->mColors.clear();
+
+            if (getTermColors() != TERM_COLORS_NONE) {
+                evalRules();
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::printPrompt
+    /// Prints the prompt of an interactive table
+    //--------------------------------------------------------------------------
+    void printPrompt(void) {
+        if (mpPrompt != NULL && cellCount(*mpPrompt) > 0) {
+            const TCell&    lrText = cellAt(*mpPrompt, 0);
+
+            if (mpPrompt->mRowAttr.test(R_ACKNOWLEDGE)) {
+                mOutput << " ";
+                printText(lrText.data(), lrText.size());
+                mOutput << ": ";
+                endline(COLOR_GREEN);
+            }
+            else {
+                printText(lrText.data(), lrText.size());
+                endline(COLOR_BRIGHT);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Evaluates the width of the table.
+    //--------------------------------------------------------------------------
+    void evalWidth(void) {
+        size_t        lCells = mpHeader->mCells.size();
+        TStringSize   lWidth = 1;
+
+        for (size_t lCell = 0; lCell < lCells; lCell++) {
+            lWidth += mpHeader->mCells[lCell].mCellAttr.mWidth + 1;
+        }
+
+        if (mpHeader->mRowAttr.mWidth < lWidth) {
+            mpHeader->mRowAttr.mWidth = lWidth;
+        }
+    }
+
+public:
+
+    //==========================================================================
+    /// @class TCursor
+    /// Resumable print of a table. Each step() prints lines until the line or
+    /// byte budget is used up and returns true while output is left, so an
+    /// event loop can print a large table in slices. The cursor keeps its
+    /// place in nested subtables and in multi-line rows. The table must not
+    /// be changed while a cursor is active.
+    //==========================================================================
+    class TCursor {
+    private:
+        typedef enum EPhase {
+            PHASE_START,        ///< Head line and layout
+            PHASE_ROWS,         ///< Header and data rows
+            PHASE_PROMPT        ///< Prompt of interactive tables
+        } EPhase;
+
+        //----------------------------------------------------------------------
+        /// Print state of one table level
+        //----------------------------------------------------------------------
+        typedef struct TFrame {
+            SfCTable*       mpTable;    ///< Table of this level
+            EPrintOption    mOption;    ///< Part of the table to print
+            EPhase          mPhase;     ///< Print phase
+            size_t          mRow;       ///< Next row
+            SAP_UINT        mSkipRows;  ///< Rows still to skip
+            SAP_UINT        mShowRows;  ///< Rows still to show
+            TRow*           mpContinue; ///< Multi-line row in progress
+        } TFrame;
+
+        vector<TFrame>      mStack;     ///< Table and open subtables
+        SfCTable*           mpRoot;     ///< Table to print
+
+        //----------------------------------------------------------------------
+        /// Opens a table level
+        //----------------------------------------------------------------------
+        void push(
+            SfCTable*       apTable,        ///< Table to print
+            EPrintOption    aOption ) {     ///< Print option
+            TFrame  lFrame;
+
+            lFrame.mpTable    = apTable;
+            lFrame.mOption    = aOption;
+            lFrame.mPhase     = PHASE_START;
+            lFrame.mRow       = 0;
+            lFrame.mSkipRows  = 0;
+            lFrame.mShowRows  = 0;
+            lFrame.mpContinue = NULL;
+            mStack.push_back(lFrame);
+        }
+
+        //----------------------------------------------------------------------
+        /// Prints the next unit: the head line, one line of a row, the header
+        /// or the prompt. A subtable opens a new level.
+        //----------------------------------------------------------------------
+        void next(void) {
+            TFrame&     lrFrame = mStack.back();
+            SfCTable&   lrTable = *lrFrame.mpTable;
+            bool        lMore;
+
+            switch (lrFrame.mPhase) {
+            case PHASE_START:
+                lrTable.printStart(lrFrame.mOption);
+
+                lrFrame.mShowRows = lrTable.mRows.size();
+
+                if (sTableLength > 0) {
+                    lrFrame.mShowRows = sTableLength;
+                }
+                else if ((sTableLength < 0) && (lrFrame.mShowRows > (SAP_UINT) (-sTableLength))) {
+                    lrFrame.mSkipRows = lrFrame.mShowRows + sTableLength;
+                }
+                lrFrame.mPhase = PHASE_ROWS;
+                return;
+
+            case PHASE_PROMPT:
+                lrTable.printPrompt();
+                mStack.pop_back();
+                return;
+
+            default:
+                break;
             }
 
             //------------------------------------------------------------------
-            // Set the cell width.
+            // Continue a multi-line row
             //------------------------------------------------------------------
-            if (lrHdr.mCellAttr.test(FIXED)) {
-                arCell.mCellAttr.mWidth = lrHdr.mCellAttr.mWidth;
+            if (lrFrame.mpContinue != NULL) {
+                lrTable.printSpace(lrTable.mIndent);
+
+                if (!lrTable.printRowLine(*lrFrame.mpContinue, COLOR_SAME)) {
+                    lrFrame.mpContinue->mContinue = false;
+                    lrFrame.mpContinue = NULL;
+                }
+                return;
             }
-            else {
-                //--------------------------------------------------------------
-                // The cell width is the maximum of:
-                // - the cell attribute width,
-                // - the header attribute width, and
-                // - the width of the data in the cell (taking line breaks into 
-                //   account).
-                //--------------------------------------------------------------
-                TStringSize lSize = 0;
-                TStringSize lPos  = 0;
-                TStringSize lOff  = 0;
 
-                while ((lPos = arCell.mValue.find('\n', lOff)) != TString::npos) {
-                    if (lSize < (lPos - lOff)) {
-                        lSize = (lPos - lOff);
+            if (lrFrame.mShowRows > 0) {
+                for (; lrFrame.mSkipRows > 0 && lrFrame.mRow < lrTable.mRows.size(); lrFrame.mRow++) {
+                    lrFrame.mSkipRows--;
+                }
+            }
+
+            if (lrFrame.mRow >= lrTable.mRows.size() || lrFrame.mShowRows == 0) {
+                lrFrame.mPhase = PHASE_PROMPT;
+                lrTable.printBottom(lrFrame.mOption);
+                return;
+            }
+
+            TRow& lrRow = lrTable.rowAt(lrFrame.mRow++);
+
+            lrTable.mOutput.str("");
+
+            if (lrRow.mRowAttr.test(R_HEADER)) {
+                if (lrFrame.mOption != PRINT_BODY) {
+                    lrTable.printHeader();
+                }
+                return;
+            }
+
+            if (lrFrame.mOption == PRINT_HEADER) {
+                if (lrRow.mRowAttr.test(R_SUBTABLE)) {
+                    SfCTable* lpSubTable = lrTable.openNode(*lrRow.mpSubTable, false);
+
+                    if (lpSubTable != NULL) {
+                        push(lpSubTable, PRINT_HEADER);
                     }
-                    lOff = lPos + 1;
                 }
+                else {
+                    lrFrame.mPhase = PHASE_PROMPT;
+                }
+                return;
+            }
+
+            lrFrame.mShowRows--;
+
+            SfCTable* lpSubTable = lrTable.printRowHead(lrRow,
+                lrRow.mRowAttr.mColor != COLOR_NONE ? lrRow.mRowAttr.mColor : lrTable.mAttr.mColor, lMore);
+
+            if (lMore) {
+                lrFrame.mpContinue = &lrRow;
+            }
+            else if (lpSubTable != NULL) {
+                lpSubTable = lrTable.openNode(*lpSubTable, true);
+
+                if (lpSubTable != NULL) {
+                    push(lpSubTable, lrTable.mPrintOption);
+                }
+            }
+        }
+
+    public:
+        //----------------------------------------------------------------------
+        /// Constructor. Nothing is printed before the first step.
+        //----------------------------------------------------------------------
+        TCursor(
+            SfCTable&           arTable,                ///< Table to print
+            const EPrintOption  aOption = PRINT_ALL ):  ///< Print option
+            mpRoot(&arTable) {
+            push(&arTable, aOption);
+        }
+
+        //----------------------------------------------------------------------
+        /// Prints the next slice of the table. A budget of 0 has no limit.
+        /// The budget is checked between lines and a table header is printed
+        /// as a whole, so a step may exceed it slightly.
+        /// @retval true    output is left for the next step.
+        /// @retval false   the table is printed.
+        //----------------------------------------------------------------------
+        bool step(
+            const SAP_ULLONG    aMaxLines = 0,      ///< Lines per step
+            const SAP_ULLONG    aMaxBytes = 0 ) {   ///< Bytes per step
+            SAP_ULLONG  lLines = 0;
+            SAP_ULLONG  lBytes = 0;
+
+            SF_STAT(TStatTimer lTimer(mpRoot->statsPtr(), STAT_NS_RENDER);)
+
+            while (!mStack.empty()) {
+                if ((aMaxLines > 0 && lLines >= aMaxLines) ||
+                    (aMaxBytes > 0 && lBytes >= aMaxBytes)) {
+                    return true;
+                }
+
+                SfCTable*   lpTable   = mStack.back().mpTable;
+                SAP_ULLONG  lLinesOut = lpTable->mLinesOut;
+                SAP_ULLONG  lBytesOut = lpTable->mBytesOut;
+
+                next();
+                lLines += lpTable->mLinesOut - lLinesOut;
+                lBytes += lpTable->mBytesOut - lBytesOut;
+            }
+            return false;
+        }
+
+        //----------------------------------------------------------------------
+        /// The table is printed completely.
+        //----------------------------------------------------------------------
+        bool done(void) const {
+            return mStack.empty();
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::print
+    /// Prints table or part of it
+    //--------------------------------------------------------------------------
+    void print( EPrintOption aOption = PRINT_ALL ) { ///< Print option
+        if (mpSpill != NULL && aOption != PRINT_HEADER) {
+            printSpill(aOption);
+            aOption = PRINT_BODY;
+        }
+        TCursor lCursor(*this, aOption);
+
+        lCursor.step();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Output manipulator hook operator.
+    /// This operator ensures that an expression of the form <code> tbl << row
+    /// </code> calls \c row(tbl), and then returns \c *this. 
+    //--------------------------------------------------------------------------
+    SfCTable& operator << (SfCTable&  (*apFn)(SfCTable&) ) {
+        return apFn(*this);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Output operator for attributes.
+    /// This operator changes the output attributed for the next output.
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( const SfCTable::TAttr&  arAttr ) {    ///< Cell attributes
+        mOpAttr = arAttr;
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Output operator for strings.
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( const TString& arValue ) {        ///< Cell value
+        addCell(TCell(arValue, getOpAttr()));
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Output operator for temporary strings.
+    /// The value is moved into the table without copying.
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( TString&& arValue ) {             ///< Cell value
+        addCell(TCell(std::move(arValue), getOpAttr()));
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( const SAP_UC* apValue ) {        ///< Cell value
+        addCell(TCell(apValue, getOpAttr()));
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Output operator for borrowed strings.
+    /// The cell refers to the caller's buffer, nothing is copied.
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( const TRef& arRef ) {            ///< Cell value
+        addCell(TCell(arRef, getOpAttr()));
+        return *this;
+    }
 
-                if (lSize == 0) {
-                    lSize = arCell.mValue.length();
-                }
+#ifdef SF_STRING_VIEW
+    //--------------------------------------------------------------------------
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( TStringView aValue ) {           ///< Cell value
+        addCell(TCell(aValue, getOpAttr()));
+        return *this;
+    }
+#endif
 
-                TStringSize lWidth = MIN(sMaxColWidth, MAX(MAX(lSize, arCell.mCellAttr.mWidth), lrHdr.mCellAttr.mWidth));
+    //--------------------------------------------------------------------------
+    /// Output operators for numeric data.
+    //--------------------------------------------------------------------------
+    SfCTable& operator << ( const SAP_ULLONG aValue ) {     ///< Cell value
+        TAttr           lAttr(getOpAttr());
+        TStringStream   lOs;
 
-                arCell.mCellAttr.mWidth = lWidth;
+        size_t          iCell = cellCount(*mpRow);
 
-                if ((lrHdr.mCellAttr.mWidth < lWidth) && !arCell.mCellAttr.test(MERGE)) {
-                    lrHdr.mCellAttr.mWidth = lWidth;
-                }
-            }
+        if (mpHeader->mCells.size() > iCell) {
+            lAttr += mpHeader->mCells[iCell].mCellAttr;
+        }
 
+        if (lAttr.test(HEX)) {
+            lOs << "0x" << hex << (SAP_UINT)(aValue & 0xFFFFFFFF);
+        }
+        else if (lAttr.test(UNSIGNED)) {
+            lOs << (SAP_ULLONG)aValue;
+        }
+        else {
+            lOs << (SAP_LLONG)aValue;
         }
+        lAttr.set(NUMBER);
 
-        lrRow.mCells.push_back(arCell);
+        addCell(TCell(lOs.str(), lAttr));
+        return *this;
     }
 
-public:
     //--------------------------------------------------------------------------
-    /// Sets or clears the SIGALRM flag.
-    /// @retval    true    if some data was read.
-    ///    @retval    false    the timeout has expired.
     //--------------------------------------------------------------------------
-    static void setAlarm( bool aValue ) {        ///< new \c sAlarmed flag value.
-        sAlarmed = aValue;
+    inline SfCTable& operator << ( const SAP_LLONG aValue ) {        ///< Cell value
+        return SfCTable::operator << ((SAP_ULLONG)aValue);
     }
 
     //--------------------------------------------------------------------------
-    /// Reads input from the terminal
-    /// @retval    true    if some data was read.
-    ///    @retval    false    the timeout has expired.
     //--------------------------------------------------------------------------
-    bool getInput(
-            TString&         arInput,           ///< the data read.
-            const SAP_INT    aTimeout = -1) {   ///< input timeout (seconds)
-        
-        SAP_UC        lA7Buffer[256];
-        SAP_INT       lErrno = 0;
-        SAP_INT       lRc = 0;
-
-        memset(lA7Buffer, 0, sizeof(lA7Buffer));
-        errno = 0;
-
-        cin >> arInput;
-        return 0;
+    inline SfCTable& operator << ( const SAP_UINT aValue ) {        ///< Cell value
+        return SfCTable::operator << ((SAP_ULLONG)aValue);
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::setHeader
-    /// Set the header row as reference.
     //--------------------------------------------------------------------------
-    void setHeader( SfCTable*    apRef ) {        ///< Reference table
-        mpHeader = &apRef->mRows.front();
+    inline SfCTable& operator << ( const SAP_INT aValue ) {        ///< Cell value
+        return SfCTable::operator << ((SAP_ULLONG)aValue);
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::redirect
-    /// Redirect output of the table into a given file
+    /// Output operator for numeric data.
     //--------------------------------------------------------------------------
-    static void redirect( FILE* apOut ) {        ///< Output file descriptor
-        if (spOut) {
-            fclose(spOut);
+    SfCTable& operator << ( const SAP_DOUBLE aValue ) {             ///< Cell value
+        size_t  iCell = cellCount(*mpRow);
+        TAttr   lAttr(getOpAttr());
+
+        if (mpHeader->mCells.size() > iCell) {
+            lAttr += mpHeader->mCells[iCell].mCellAttr;
         }
-        spOut = apOut;
+        TStringStream lOs;
+
+        lOs << aValue;
+        lAttr.set(NUMBER);
+
+        addCell(TCell(lOs.str(), lAttr));
+        return *this;
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::setAttr
-    /// Sets the colors and attributes for output
+    /// Modification operator for field attributes.
     //--------------------------------------------------------------------------
-    static SAP_UINT setAttr(const SAP_UINT aAttr);    ///< New colors and attributes
+    SfCTable& operator << ( const EFlags& arFlag ) {        ///< the new layout flag value.
+        mOpAttr += arFlag;
+        return *this;
+    }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::setTableLength
-    /// Set max number of table rows for output
+    /// Marks the header as visible.
     //--------------------------------------------------------------------------
-    inline static void setTableLength( const SAP_INT aTableLength ) {
-        sTableLength = aTableLength;
+    SfCTable& hdr( const TAttr&    arAttr = TAttr() ) {    ///< Row attributes
+        mpHeader->mRowAttr.reset(SfCTable::R_INVISIBLE);
+        mpHeader->mRowAttr += arAttr;
+        return *this;
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::getTableLength
-    /// get max number of table rows for output
+    /// Appends a data row to the table.
     //--------------------------------------------------------------------------
-    inline static SAP_INT getTableLength() {
-        return sTableLength;
+    SfCTable& row( const TAttr&    arAttr = TAttr() ) {    ///< Row attributes
+        //----------------------------------------------------------------------
+        // Check for table overflow.
+        //----------------------------------------------------------------------
+        if (mRingSize > 0) {
+            if (mRows.size() > mRingSize) {
+                ringRow(arAttr);
+                return *this;
+            }
+        }
+        else if ((mPageLength > 0) && (mRows.size() > mPageLength)) {
+            flushPage();
+        }
+
+        if (!admitRow()) {
+            return *this;
+        }
+        newRow(arAttr);
+        return *this;
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::setPageLength
-    /// Set max number of table rows
+    /// Appends columns of data as rows, e.g.
+    /// appendColumns({TColumn(lIds), TColumn(lNames), TColumn(lLoads)}).
+    /// Each column is formatted and measured in one pass and its header width
+    /// is updated once. The width of a number is its length, only strings are
+    /// measured. The values are formatted like the output operators, HEX
+    /// shows the lower 32 bits in hexadecimal.
+    /// @return false if the columns differ in length or exceed the limit
     //--------------------------------------------------------------------------
-    inline static void setPageLength( const SAP_UINT    aPageLength ) {
-        sPageLength = aPageLength;
+    bool appendColumns(
+        const vector<TColumn>&  arCols,                 ///< Columns
+        const TAttr&            arAttr = TAttr() ) {    ///< Row attributes
+        size_t  lRows = arCols.empty() ? 0 : arCols.front().mSize;
+        size_t  lCols = arCols.size();
+
+        for (size_t iCol = 0; iCol < lCols; iCol++) {
+            if (arCols[iCol].mSize != lRows) {
+                cerr << "SfCTable::appendColumns: column " << iCol << " has " << arCols[iCol].mSize
+                     << " values, expected " << lRows << ".\n";
+                return false;
+            }
+        }
+
+        if ((mMaxColCount > 0) && (lCols > mMaxColCount)) {
+            cerr << "SfCTable::appendColumns: too many columns, limit is " << mMaxColCount << ".\n";
+            return false;
+        }
+
+        if (mpHeader->mCells.size() < lCols) {
+            mpHeader->mCells.resize(lCols);
+        }
+
+        //----------------------------------------------------------------------
+        // A ring drops rows one by one and a budget checks each row, the
+        // rows are added as usual.
+        //----------------------------------------------------------------------
+        if (mRingSize > 0 || budgetTable() != NULL) {
+            SAP_ULLONG  lRejected = budgetTable() ? budgetTable()->mRejected : 0;
+
+            for (size_t iRow = 0; iRow < lRows; iRow++) {
+                row(arAttr);
+
+                for (size_t iCol = 0; iCol < lCols; iCol++) {
+                    TCell lCell;
+
+                    formatCell(lCell, arCols[iCol], iRow, mpHeader->mCells[iCol].mCellAttr);
+                    addCell(std::move(lCell));
+                }
+            }
+            return (budgetTable() ? budgetTable()->mRejected : 0) == lRejected;
+        }
+
+        //----------------------------------------------------------------------
+        // Insert blocks up to the page length.
+        //----------------------------------------------------------------------
+        for (size_t lDone = 0; lDone < lRows; ) {
+            if ((mPageLength > 0) && (mRows.size() > mPageLength)) {
+                flushPage();
+            }
+
+            size_t  lBlock = lRows - lDone;
+            size_t  lFirst = mRows.size();
+
+            if ((mPageLength > 0) && (lBlock > mPageLength + 1 - mRows.size())) {
+                lBlock = mPageLength + 1 - mRows.size();
+            }
+
+            for (size_t iRow = 0; iRow < lBlock; iRow++) {
+                TRow&   lrRow = newRow(arAttr);
+
+                if (lrRow.mCodeRow == DICT_NONE) {
+                    lrRow.mCells.resize(lCols);
+                }
+                else {
+                    lrRow.mCells.resize(mpDict->cellOf(lCols));
+                    mpDict->codes(lrRow.mCodeRow)[0] = (SAP_UINT)lCols;
+                }
+            }
+
+            for (size_t iCol = 0; iCol < lCols; iCol++) {
+                appendColumn(arCols[iCol], iCol, lDone, lFirst, lBlock);
+            }
+            lDone += lBlock;
+        }
+        return true;
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::getPageLength
-    /// Get max table length
+    /// Appends a row major block of values of one type, e.g. a matrix.
+    /// @return false if the columns exceed the limit
     //--------------------------------------------------------------------------
-    inline static SAP_INT getPageLength() {
-        return sPageLength;
+    template<typename T>
+    bool appendRows(
+        const T*        apData,                 ///< Values, row by row
+        size_t          aRows,                  ///< Number of rows
+        size_t          aCols,                  ///< Values per row
+        const TAttr&    arAttr = TAttr() ) {    ///< Row attributes
+        vector<TColumn> lCols;
+
+        lCols.reserve(aCols);
+        for (size_t iCol = 0; iCol < aCols; iCol++) {
+            lCols.push_back(TColumn(apData + iCol, aRows, TAttr(), aCols));
+        }
+        return appendColumns(lCols, arAttr);
     }
 
+private:
     //--------------------------------------------------------------------------
-    /// SfCTable::setColor
-    /// Sets the color for output
-    /// @return The old color attribute
+    /// Formats a value of a column into a cell with the merged flags.
     //--------------------------------------------------------------------------
-    SAP_UINT setColor(const EColor aColor);       ///< New color
+    static void formatCell(
+        TCell&          arCell,                 ///< Cell to fill
+        const TColumn&  arCol,                  ///< Column
+        const size_t    aRow,                   ///< Row in the column
+        const TAttr&    arHdrAttr ) {           ///< Header attributes
+        SAP_UC      lBuffer[32];
+        SAP_UC*     lpEnd   = lBuffer + sizeof(lBuffer);
+        SAP_UC*     lpStart = lpEnd;
+        SAP_LLONG   lValue  = 0;
+        size_t      lPos    = aRow * arCol.mStride;
+
+        arCell.mCellAttr = arCol.mAttr;
+        arCell.mCellAttr.mFlags |= arHdrAttr.mFlags;
+
+        switch (arCol.mType) {
+        case TColumn::COL_STRING:
+            arCell.own() = ((const TString*)arCol.mpData)[lPos];
+            return;
 
-    //--------------------------------------------------------------------------
-    //--------------------------------------------------------------------------
-    inline TAttr getOpAttr(void) {
-        TAttr        lAttr(mOpAttr);
+        case TColumn::COL_CHARS:
+            arCell.own() = ((const SAP_UC* const*)arCol.mpData)[lPos];
+            return;
 
-        mOpAttr = TAttr();
-        return lAttr;
-    }
+        case TColumn::COL_DOUBLE:
+            lpStart = decimal(lpEnd, ((const SAP_DOUBLE*)arCol.mpData)[lPos]);
 
+            if (lpStart != NULL) {
+                arCell.own().assign(lpStart, lpEnd - lpStart);
+            }
+            else {
+                arCell.own().assign(lBuffer,
+                    snprintf(lBuffer, sizeof(lBuffer), "%g", ((const SAP_DOUBLE*)arCol.mpData)[lPos]));
+            }
+            arCell.mCellAttr.set(NUMBER);
+            return;
 
-private:
-    //--------------------------------------------------------------------------
-    /// SfCTable::endline
-    /// Trigger the output
-    //--------------------------------------------------------------------------
-    void endline(const SfCTable::EColor aColor);
+        case TColumn::COL_INT:
+            lValue = ((const SAP_INT*)arCol.mpData)[lPos];
+            break;
+
+        case TColumn::COL_LLONG:
+            lValue = ((const SAP_LLONG*)arCol.mpData)[lPos];
+            break;
+        }
+
+        arCell.mCellAttr.set(NUMBER);
+
+        if (arCell.mCellAttr.test(BOOL)) {
+            arCell.borrow(lValue ? "true" : "false", lValue ? 4 : 5);
+            return;
+        }
+
+        if (arCell.mCellAttr.test(YESNO)) {
+            arCell.borrow(lValue ? "yes" : "no", lValue ? 3 : 2);
+            return;
+        }
+
+        if (arCell.mCellAttr.test(HEX)) {
+            lpStart = digits(lpEnd, (SAP_ULLONG)lValue & 0xFFFFFFFF, 16);
+            *--lpStart = 'x';
+            *--lpStart = '0';
+        }
+        else if (lValue < 0 && !arCell.mCellAttr.test(UNSIGNED)) {
+            lpStart = digits(lpEnd, 0 - (SAP_ULLONG)lValue, 10);
+            *--lpStart = '-';
+        }
+        else {
+            lpStart = digits(lpEnd, (SAP_ULLONG)lValue, 10);
+        }
+        arCell.own().assign(lpStart, lpEnd - lpStart);
+    }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::printSpace
-    /// Print spaces
+    /// Fills a column of a block of new rows and widens the column once.
+    /// A DICT column is formatted into a spare cell and stored as codes.
     //--------------------------------------------------------------------------
-    void printSpace(
-        const size_t    aWidth,             ///< number of fill characters
-        const SAP_UC    aChar = ' ') {      ///< the character to fill with
-        mOutput << TString(MIN(aWidth, sMaxRowWidth), aChar);
+    void appendColumn(
+        const TColumn&  arCol,                  ///< Column data
+        const size_t    iCol,                   ///< Column
+        const size_t    aFrom,                  ///< First value
+        const size_t    aFirst,                 ///< First row of the block
+        const size_t    aCount ) {              ///< Rows in the block
+        TCell&          lrHdr   = mpHeader->mCells[iCol];
+        bool            lFixed  = lrHdr.mCellAttr.test(FIXED);
+        TStringSize     lHdrWidth = lrHdr.mCellAttr.mWidth;
+        TStringSize     lWidth  = lHdrWidth;
+        bool            lText   = arCol.mType == TColumn::COL_STRING || arCol.mType == TColumn::COL_CHARS;
+        SAP_INT         lDict   = mpDict ? mpDict->dictOf(iCol) : -1;
+        TCell           lDictCell;
+        SF_STAT(TStatTimer lTimer(&mStats, STAT_NS_INGEST);)
+
+        if ((mFitWidth > 0) && (mColStats.size() <= iCol)) {
+            mColStats.resize(iCol + 1);
+        }
+
+        for (size_t iRow = 0; iRow < aCount; iRow++) {
+            TRow&   lrRow  = mRows[aFirst + iRow];
+            TCell&  lrCell = (lDict < 0) ? cellAt(lrRow, iCol) : lDictCell;
+
+            formatCell(lrCell, arCol, aFrom + iRow, lrHdr.mCellAttr);
+
+            if (lDict >= 0) {
+                addBytes(mpDict->mDicts[lDict].intern(lrCell));
+                mpDict->codes(lrRow.mCodeRow)[1 + lDict] = lrCell.mCode;
+            }
+            else if (lText) {
+                lrCell.measure();
+                addBytes(cellBytes(lrCell));
+            }
+            else {
+                lrCell.measureAscii();
+                addBytes(cellBytes(lrCell));
+            }
+            lrRow.hashCell(lrCell);
+
+            if (lFixed) {
+                lrCell.mCellAttr.mWidth = lHdrWidth;
+                continue;
+            }
+
+            if (lrCell.mCellAttr.test(MERGE)) {
+                fitCell(lrCell, lrHdr, iCol);
+                continue;
+            }
+
+            TStringSize lSize = lrCell.mDispWidth;
+
+            lWidth = MAX(lWidth, MIN(sMaxColWidth, MAX(lSize, lrCell.mCellAttr.mWidth)));
+            lrCell.mCellAttr.mWidth = lWidth;
+
+            if (mFitWidth > 0) {
+                mColStats[iCol].add(lSize, lrCell.mCellAttr.test(NUMBER));
+                mColStats[iCol].mMax = MAX(mColStats[iCol].mMax, lSize);
+            }
+        }
+        SF_STAT(addStat(&mStats, STAT_CELLS, aCount);)
+
+        if (lWidth > lHdrWidth) {
+            lrHdr.mCellAttr.mWidth = lWidth;
+
+            if (mpLayout) {
+                mpLayout->merge(iCol, lWidth);
+            }
+        }
     }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::printLine
-    /// Prints a separator line.
+    /// Adds an empty row at the end of the table. Rows of flushed pages are
+    /// reused. The first data row fixes the DICT columns.
     //--------------------------------------------------------------------------
-    void printLine(
-        TRow&           arRow,                      ///< Row to print
-        const EColor    aColor = COLOR_BRIGHT ) {   ///< Row color
-        TCells::iterator lIt;
-
-        for (lIt = arRow.mCells.begin(); lIt != arRow.mCells.end(); lIt++) {
-            mOutput << "+" << TString(lIt->mCellAttr.mWidth, '-');
+    TRow& newRow( const TAttr& arAttr ) {       ///< Row attributes
+        if (!mDictFixed) {
+            fixDictCols();
         }
 
-        if (mAttr.mWidth > mOutput.str().size()) {
-            mOutput << TString(mAttr.mWidth - mOutput.str().size(), '-');
+        if (mFreeRows.empty()) {
+            mRows.emplace_back();
+        }
+        else {
+            mRows.push_back(std::move(mFreeRows.back()));
+            mFreeRows.pop_back();
         }
 
-        mOutput << "+";
-        endline(aColor);
+        TRow& lrRow = mRows.back();
 
-        if (mAttr.mColor == COLOR_TOGGLE) {
-            mAttr.mColor = COLOR_TOGGLE_DARK;
+        mpRow = &lrRow;
+
+        if (mpDict) {
+            lrRow.mCodeRow = mpDict->alloc();
         }
+        SF_STAT(addStat(&mStats, STAT_ROWS, 1);)
+        addBytes(sizeof(TRow) + codeBytes(lrRow));
+
+        lrRow.mpHeader = mpHeader;
+        lrRow.mRowAttr = arAttr;
+        lrRow.mRowAttr |= mAttr.mFlags;
+        lrRow.mCells.reserve(mpDict ? mpDict->cellOf(mpHeader->mCells.size()) : mpHeader->mCells.size());
+        return lrRow;
     }
 
-
+public:
     //--------------------------------------------------------------------------
-    /// SfCTable::printHeader
-    /// Prints the header of a table.
+    /// Creates a subtable.
+    /// The current row acts as a placeholder for the subtable in the superior
+    /// table. Sibling subtables with the same columns pass the subtable that
+    /// defines the header as apLayout: they share its layout and column
+    /// widths and do not define a header of their own. The shared layout
+    /// outlives apLayout. The returned pointer is owned by this table and is
+    /// invalid after a page flush, see setLimits.
     //--------------------------------------------------------------------------
-    void printHeader(void) {
-        if (mpHeader->mRowAttr.test(R_INVISIBLE)) {
-            return;
+    SfCTable* subTable(
+        const TAttr&    arAttr = TAttr(),       ///< Subtable attributes
+        SfCTable*       apLayout = NULL ) {     ///< Sibling with the header
+        row(arAttr);
+
+        if (mRejectRow) {
+            mRejectRow = false;
+            newRow(arAttr);
         }
 
-        printSpace(mIndent);
-        printLine(*mpHeader, COLOR_BRIGHT);
+        TRow&        lrRow = *mpRow;
 
-        printRow(*mpHeader, COLOR_BRIGHT);
+        lrRow.mRowAttr.set(R_SUBTABLE);
+        lrRow.mpSubTable = new SfCTable(*this, arAttr);
+        lrRow.mpSubTable->addBytes(sizeof(SfCTable));
 
-        printSpace(mIndent);
-        printLine(*mpHeader, COLOR_BRIGHT);
+        if (apLayout != NULL) {
+            lrRow.mpSubTable->setLayout(apLayout->shareLayout());
+        }
+        return lrRow.mpSubTable;
     }
 
+    //--------------------------------------------------------------------------
+    /// Creates a lazy subtable.
+    /// The subtable starts collapsed and empty. Its rows are added by the
+    /// callback, when the subtable is printed expanded for the first time,
+    /// so collapsed branches of a large tree are never built.
+    //--------------------------------------------------------------------------
+    SfCTable* subTable(
+        const TAttr&    arAttr,                 ///< Subtable attributes
+        SfCTable*       apLayout,               ///< Sibling with the header
+        const TExpand&  arExpand ) {            ///< Fills the subtable
+        SfCTable* lpSubTable = subTable(arAttr, apLayout);
+
+        lpSubTable->mExpand   = arExpand;
+        lpSubTable->mExpanded = false;
+        return lpSubTable;
+    }
 
     //--------------------------------------------------------------------------
-    /// SfCTable::printRow
-    /// Prints a row of a table
+    /// SfCTable::setExpanded
+    /// Expand or collapse this subtable. A collapsed subtable prints no rows,
+    /// in tree mode it prints a [+] marker.
     //--------------------------------------------------------------------------
-    void printRow(
-        TRow&           arRow,                  ///< Row to print
-        const EColor    aColor = COLOR_NONE ) { ///< Row color
+    void setExpanded( const bool aExpanded ) {  ///< Print the rows
+        mExpanded = aExpanded;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::isExpanded
+    //--------------------------------------------------------------------------
+    bool isExpanded(void) const {
+        return mExpanded;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::setTree
+    /// Tree mode for this table and its future subtables: each subtable is
+    /// preceded by a marker line, [-] if expanded and [+] if collapsed.
+    //--------------------------------------------------------------------------
+    void setTree( const bool aTree ) {          ///< Print tree markers
+        mTree = aTree;
+    }
+
+    //--------------------------------------------------------------------------
+    /// SfCTable::groupBy
+    /// Groups the rows of this table by the key columns into the target
+    /// table: one row per group with the key values and the aggregates, in
+    /// the order the groups first appear. The rows are hashed in one pass
+    /// and the memory grows with the number of groups. With aDetail each
+    /// group row is followed by a subtable with the rows of the group, which
+    /// takes memory for the row numbers as well. Only the rows of the
+    /// current page are grouped. The header of an empty target is filled
+    /// with the key column names and the aggregate names.
+    //--------------------------------------------------------------------------
+    void groupBy(
+        SfCTable&               arTarget,           ///< Table of the groups
+        const vector<size_t>&   arKeys,             ///< Key columns
+        const vector<TAgg>&     arAggs,             ///< Aggregates
+        const bool              aDetail = false ) { ///< Add the rows as subtables
+        vector<TGroup>  lGroups;
+        TLayoutPtr      lpLayout;
+
+        collectGroups(lGroups, arKeys, aDetail, [&](TGroup& arGroup, const TRow& arRow) {
+            arGroup.mAcc.resize(arAggs.size());
 
-        if (arRow.mRowAttr.test(R_LINE)) {
-            printSpace(mIndent);
-            printLine(*mpHeader);
-            return;
-        }
+            for (size_t iAgg = 0; iAgg < arAggs.size(); iAgg++) {
+                size_t  lCol = arAggs[iAgg].mCol;
 
-        if (arRow.mRowAttr.test(R_INVISIBLE)) {
-            return;
-        }
-        printSpace(mIndent);
+                arGroup.mAcc[iAgg].add(arAggs[iAgg], (lCol < cellCount(arRow)) ? &cellAt(arRow, lCol) : NULL);
+            }
+        });
 
-        if (arRow.mRowAttr.test(R_PROMPT) ||
-            arRow.mRowAttr.test(R_ACKNOWLEDGE)) {
-            mpPrompt = &arRow;
-            return;
-        }
+        if (arTarget.mpHeader->mCells.empty()) {
+            arTarget.hdr();
+            addKeyNames(arTarget, arKeys);
 
-        if (arRow.mRowAttr.test(R_SUBTABLE)) {
-            arRow.mpSubTable->print(mPrintOption);
-            return;
+            for (size_t iAgg = 0; iAgg < arAggs.size(); iAgg++) {
+                arTarget << aggName(arAggs[iAgg]);
+            }
         }
 
-        TCells::iterator lHdrIt = mpHeader->mCells.begin();
-        TCells::iterator lCellIt = arRow.mCells.begin();
-        TString          lValue;
-        size_t           lFill = 0;
-        TAttr            lAttr;
-        bool             lRemain = false;
-        bool             lHasRes = false;
-
-        mOutput << (arRow.mRowAttr.test(R_MESSAGE) ? " " : sSepStr);
+        for (size_t iGroup = 0; iGroup < lGroups.size(); iGroup++) {
+            TGroup& lrGroup = lGroups[iGroup];
 
-        //----------------------------------------------------------------------
-        // Process the cells of the row.
-        //----------------------------------------------------------------------
-        while (lHdrIt != mpHeader->mCells.end() && lCellIt != arRow.mCells.end()) {
-            TCell&    lrCurCell = (*lCellIt);
-            TCell&    lrHdrCell = (*lHdrIt);
-            size_t    lWidth = lrHdrCell.mCellAttr.mWidth;
-            size_t    lSize = 0;
+            addKeyCells(arTarget, arKeys, lrGroup);
 
-            lAttr = lrCurCell.mCellAttr;
+            for (size_t iAgg = 0; iAgg < arAggs.size(); iAgg++) {
+                addAggCell(arTarget, arAggs[iAgg], lrGroup.mAcc[iAgg]);
+            }
 
+            if (!aDetail) {
+                continue;
+            }
             //------------------------------------------------------------------
-            // Fetch the cell contents.
+            // The detail tables share one layout. A page flush of the target
+            // may delete the first detail table, the layout stays.
             //------------------------------------------------------------------
-            if (lCellIt != arRow.mCells.end()) {
-                lValue = lrCurCell.getValue(arRow.mContinue, lHasRes);
-                lRemain = lRemain || lHasRes;
-                lSize = lValue.size();
+            SfCTable* lpDetail = arTarget.subTable();
+
+            if (lpLayout) {
+                lpDetail->setLayout(lpLayout);
             }
             else {
-                lValue = "";
+                for (size_t iCell = 0; iCell < mpHeader->mCells.size(); iCell++) {
+                    copyCell(*lpDetail, mpHeader->mCells[iCell]);
+                }
+                lpLayout = lpDetail->shareLayout();
             }
 
-            if ((lWidth < lSize) && lrCurCell.mCellAttr.test(MERGE)) {
-                //--------------------------------------------------------------
-                // Check how many colums the MERGE cell spans.
-                //--------------------------------------------------------------
-                lHdrIt++;
-                while (lHdrIt != mpHeader->mCells.end()) {
-                    lWidth += lHdrIt->mCellAttr.mWidth + 1;
-                    if (lWidth >= lSize) {
-                        break;
-                    }
-                    lHdrIt++;
-                }
+            for (size_t iRow = 0; iRow < lrGroup.mRows.size(); iRow++) {
+                TRow&   lrRow = rowAt(lrGroup.mRows[iRow]);
 
-                if ((lWidth < lSize) && (lHdrIt == mpHeader->mCells.end())) {
-                    //----------------------------------------------------------
-                    // Use everything that is lelft...
-                    //----------------------------------------------------------
-                    lWidth = mAttr.mWidth - mOutput.str().size();
+                lpDetail->row(TAttr(lrRow.mRowAttr.mFlags & (1 << R_INVISIBLE), lrRow.mRowAttr.mColor));
+
+                for (size_t iCell = 0; iCell < cellCount(lrRow); iCell++) {
+                    copyCell(*lpDetail, cellAt(lrRow, iCell));
                 }
             }
+            lrGroup.mRows = vector<size_t>();
+        }
+    }
 
-            //------------------------------------------------------------------
-            // Compute the fill space and the printable value.
-            //------------------------------------------------------------------
-            if (lWidth >= lValue.size()) {
-                lFill = lWidth - lValue.size();
-            }
-            else {
-                lFill = 0;
-                lValue = lValue.substr(0, lWidth - 1) + "*";
+    //--------------------------------------------------------------------------
+    /// SfCTable::pivot
+    /// Pivots the rows of this table into the target table: one row per
+    /// group of the key columns and one column per distinct value of the
+    /// pivot column, in the order the values first appear. A cell holds the
+    /// aggregate of the rows with its group and pivot value, and stays empty
+    /// if there is none. The memory grows with the groups times the values.
+    /// The header of an empty target is filled with the key column names and
+    /// the pivot values.
+    //--------------------------------------------------------------------------
+    void pivot(
+        SfCTable&               arTarget,           ///< Pivot table
+        const vector<size_t>&   arKeys,             ///< Key columns
+        const size_t            aPivotCol,          ///< Column of the new columns
+        const TAgg&             arAgg ) {           ///< Aggregate of the cells
+        vector<TGroup>                      lGroups;
+        vector<TString>                     lNames;
+        std::unordered_map<TString, size_t> lValues;
+
+        collectGroups(lGroups, arKeys, false, [&](TGroup& arGroup, const TRow& arRow) {
+            TString lValue;
+
+            if (aPivotCol < cellCount(arRow)) {
+                lValue.assign(cellAt(arRow, aPivotCol).data(), cellAt(arRow, aPivotCol).size());
             }
 
-            if (lAttr.test(RIGHT) ||
-               (lAttr.test(NUMBER) && !arRow.mRowAttr.test(R_HEADER) && !lAttr.test(LEFT))) {
-                // right align for numbers
-                printSpace(lFill);
-                mOutput << lValue;
-            }
-            else {
-                mOutput << lValue;
-                printSpace(lFill);
-            }
+            size_t  lCol = lValues.insert(std::make_pair(lValue, lNames.size())).first->second;
 
-            //------------------------------------------------------------------
-            // Increment the iterators.
-            //------------------------------------------------------------------
-            if (lHdrIt != mpHeader->mCells.end()) {
-                lHdrIt++;
+            if (lCol == lNames.size()) {
+                lNames.push_back(lValue);
             }
-            
-            if (lCellIt != arRow.mCells.end()) {
-                lCellIt++;
+
+            if (arGroup.mAcc.size() <= lCol) {
+                arGroup.mAcc.resize(lCol + 1);
             }
-            //------------------------------------------------------------------
-            // Emit a seprator if there is somethiing left.
-            //------------------------------------------------------------------
-            if ((lHdrIt != mpHeader->mCells.end()) && (lCellIt != arRow.mCells.end())) {
-                mOutput << sSepStr;
+            arGroup.mAcc[lCol].add(arAgg, (arAgg.mCol < cellCount(arRow)) ? &cellAt(arRow, arAgg.mCol) : NULL);
+        });
+
+        if (arTarget.mpHeader->mCells.empty()) {
+            arTarget.hdr();
+            addKeyNames(arTarget, arKeys);
+
+            for (size_t iCol = 0; iCol < lNames.size(); iCol++) {
+                arTarget << lNames[iCol];
             }
         }
 
-        if (mAttr.mWidth > mOutput.str().size()) {
-            printSpace(mAttr.mWidth - mOutput.str().size());
-        }
-        mOutput << (arRow.mRowAttr.test(R_MESSAGE) ? " " : sSepStr);
+        for (size_t iGroup = 0; iGroup < lGroups.size(); iGroup++) {
+            TGroup& lrGroup = lGroups[iGroup];
 
-        endline(aColor);
+            lrGroup.mAcc.resize(lNames.size());
+            addKeyCells(arTarget, arKeys, lrGroup);
 
-        if (lRemain) {
-            arRow.mContinue = lRemain;
-            printRow(arRow, COLOR_SAME);
+            for (size_t iCol = 0; iCol < lNames.size(); iCol++) {
+                addAggCell(arTarget, arAgg, lrGroup.mAcc[iCol]);
+            }
         }
     }
 
     //--------------------------------------------------------------------------
-    /// Evaluates the width of the table.
+    /// SfCTable::diff
+    /// Compares this table with an older snapshot of the same columns and
+    /// writes the differences into the target table. The rows are matched
+    /// by their key columns through a hash index of the old rows. Matched
+    /// rows with the same content hash are skipped without comparing the
+    /// cells. The first column of the target marks the rows: + added and
+    /// shown green, - removed and shown red, ~ changed. A changed cell shows
+    /// the old and the new value and is highlighted blue on color terminals.
+    /// Added and changed rows come in the order of this table, the removed
+    /// rows follow in the order of the old table.
+    /// @return Number of rows that differ, -1 if the headers differ
     //--------------------------------------------------------------------------
-    void evalWidth(void) {
-        size_t        lCells = mpHeader->mCells.size();
-        TStringSize   lWidth = 1;
-
-        for (size_t lCell = 0; lCell < lCells; lCell++) {
-            lWidth += mpHeader->mCells[lCell].mCellAttr.mWidth + 1;
-        }
-
-        if (mpHeader->mRowAttr.mWidth < lWidth) {
-            mpHeader->mRowAttr.mWidth = lWidth;
+    SAP_INT diff(
+        SfCTable&               arTarget,       ///< Table of the differences
+        SfCTable&               arOld,          ///< Older snapshot
+        const vector<size_t>&   arKeys ) {      ///< Key columns
+        std::unordered_multimap<TString, size_t>    lIndex;
+        vector<bool>    lMatched(arOld.mRows.size(), false);
+        TString         lKey;
+        SAP_INT         lDiffs = 0;
+
+        if (!sameHeader(arOld)) {
+            cerr << "SfCTable::diff: the tables have different columns.\n";
+            return -1;
         }
-    }
 
-public:
+        if (arTarget.mpHeader->mCells.empty()) {
+            arTarget.hdr() << "";
 
-    //--------------------------------------------------------------------------
-    /// SfCTable::print
-    /// Prints table or part of it
-    //--------------------------------------------------------------------------
-    void print( EPrintOption aOption = PRINT_ALL ) { ///< Print option
-        mPrintOption = aOption;
+            for (size_t iCell = 0; iCell < mpHeader->mCells.size(); iCell++) {
+                copyCell(arTarget, mpHeader->mCells[iCell]);
+            }
+        }
 
         //----------------------------------------------------------------------
-        // Print the table head line.
+        // Index the old rows by key.
         //----------------------------------------------------------------------
-        if (aOption != PRINT_BODY && mHeadLine != "") {
-            printSpace(mIndent);
-            mOutput << mHeadLine;
-            endline(mAttr.mColor);
+        lIndex.reserve(arOld.mRows.size());
+
+        for (size_t iRow = 1; iRow < arOld.mRows.size(); iRow++) {
+            TRow&   lrRow = arOld.rowAt(iRow);
+
+            if (isDataRow(lrRow)) {
+                arOld.rowKey(lrRow, arKeys, lKey);
+                lIndex.insert(std::make_pair(lKey, iRow));
+            }
         }
 
         //----------------------------------------------------------------------
-        // Print the table header.
+        // Match the new rows.
         //----------------------------------------------------------------------
-        evalWidth();
+        for (size_t iRow = 1; iRow < mRows.size(); iRow++) {
+            TRow&   lrRow = rowAt(iRow);
+
+            if (!isDataRow(lrRow)) {
+                continue;
+            }
+            rowKey(lrRow, arKeys, lKey);
 
-        TRows::iterator    lRowIt = mRows.begin();
-        SAP_UINT    lSkipRows = 0;
-        SAP_UINT    lShowRows = mRows.size();
-        SAP_UINT    lNumRow = 0;
+            auto    lIt = lIndex.find(lKey);
 
-        if (sTableLength > 0) {
-            lShowRows = sTableLength;
-        }
-        else if ((sTableLength < 0) && (lShowRows > (SAP_UINT) (-sTableLength))) {
-            lSkipRows = lShowRows + sTableLength;
-        }
+            if (lIt == lIndex.end()) {
+                arTarget.row(TAttr(0, COLOR_GREEN));
+                arTarget << "+";
 
-        for (; lRowIt != mRows.end() && lShowRows > 0; ++lRowIt) {
-            if (lSkipRows > 0) {
-                lSkipRows--;
+                for (size_t iCell = 0; iCell < cellCount(lrRow); iCell++) {
+                    copyCell(arTarget, cellAt(lrRow, iCell));
+                }
+                lDiffs++;
                 continue;
             }
 
-            TRow& lrRow = (*lRowIt);
+            TRow&   lrOld = arOld.rowAt(lIt->second);
 
-            mOutput.str("");
+            lMatched[lIt->second] = true;
+            lIndex.erase(lIt);
 
-            if (lrRow.mRowAttr.test(R_HEADER)) {
-                if (aOption != PRINT_BODY) {
-                    printHeader();
-                }
+            if (lrOld.mHash == lrRow.mHash) {
+                continue;
             }
-            else {
-                if (aOption == PRINT_HEADER) {
-                    if (lrRow.mRowAttr.test(R_SUBTABLE)) {
-                        lrRow.mpSubTable->print(aOption);
-                        continue;
-                    }
-                    else {
-                        break;
-                    }
+
+            arTarget.row();
+            arTarget << "~";
+
+            for (size_t iCell = 0; iCell < cellCount(lrRow) || iCell < arOld.cellCount(lrOld); iCell++) {
+                TCell   lEmpty;
+                TCell&  lrNew = iCell < cellCount(lrRow) ? cellAt(lrRow, iCell) : lEmpty;
+                TCell&  lrWas = iCell < arOld.cellCount(lrOld) ? arOld.cellAt(lrOld, iCell) : lEmpty;
+
+                if (lrNew.size() == lrWas.size() && memcmp(lrNew.data(), lrWas.data(), lrNew.size()) == 0) {
+                    copyCell(arTarget, lrNew);
+                    continue;
                 }
-                printRow( lrRow, lrRow.mRowAttr.mColor != COLOR_NONE ? lrRow.mRowAttr.mColor : mAttr.mColor );
-                lShowRows--;
+                arTarget.addCell(TCell(TString(lrWas.data(), lrWas.size()) + " -> " + TString(lrNew.data(), lrNew.size()),
+                    TAttr(1 << HIGHLIGHT, COLOR_BLUE)));
             }
+            lDiffs++;
         }
 
         //----------------------------------------------------------------------
-        // print a prompt
+        // Old rows without a match are removed.
         //----------------------------------------------------------------------
-        if (mpPrompt != NULL && mpPrompt->mCells.size() > 0) {
-            if (mpPrompt->mRowAttr.test(R_ACKNOWLEDGE)) {
-                mOutput << " " << mpPrompt->mCells.front().mValue << ": ";
-                endline(COLOR_GREEN);
+        for (size_t iRow = 1; iRow < arOld.mRows.size(); iRow++) {
+            TRow&   lrRow = arOld.rowAt(iRow);
+
+            if (lMatched[iRow] || !isDataRow(lrRow)) {
+                continue;
             }
-            else {
-                mOutput << mpPrompt->mCells.front().mValue;
-                endline(COLOR_BRIGHT);
+            arTarget.row(TAttr(0, COLOR_RED));
+            arTarget << "-";
+
+            for (size_t iCell = 0; iCell < arOld.cellCount(lrRow); iCell++) {
+                copyCell(arTarget, arOld.cellAt(lrRow, iCell));
             }
+            lDiffs++;
         }
+        return lDiffs;
     }
 
+private:
     //--------------------------------------------------------------------------
-    /// Output manipulator hook operator.
-    /// This operator ensures that an expression of the form <code> tbl << row
-    /// </code> calls \c row(tbl), and then returns \c *this. 
+    /// SfCTable::isDataRow
+    /// The row holds data, it is no subtable, line, prompt or message
     //--------------------------------------------------------------------------
-    SfCTable& operator << (SfCTable&  (*apFn)(SfCTable&) ) {
-        return apFn(*this);
+    static bool isDataRow( const TRow& arRow ) {    ///< Row
+        return !(arRow.mRowAttr.test(R_SUBTABLE) || arRow.mRowAttr.test(R_LINE)   ||
+                 arRow.mRowAttr.test(R_PROMPT)   || arRow.mRowAttr.test(R_ACKNOWLEDGE) ||
+                 arRow.mRowAttr.test(R_MESSAGE)  || arRow.mRowAttr.test(R_HEADER));
     }
 
     //--------------------------------------------------------------------------
-    /// Output operator for attributes.
-    /// This operator changes the output attributed for the next output.
+    /// SfCTable::rowKey
+    /// Key of a row: the values of the key columns, each ending with a zero
     //--------------------------------------------------------------------------
-    SfCTable& operator << ( const SfCTable::TAttr&  arAttr ) {    ///< Cell attributes
-        mOpAttr = arAttr;
-        return *this;
+    void rowKey(
+        const TRow&             arRow,          ///< Row
+        const vector<size_t>&   arKeys,         ///< Key columns
+        TString&                arKey ) const { ///< Key, the buffer is reused
+        arKey.clear();
+
+        for (size_t iKey = 0; iKey < arKeys.size(); iKey++) {
+            if (arKeys[iKey] < cellCount(arRow)) {
+                arKey.append(cellAt(arRow, arKeys[iKey]).data(), cellAt(arRow, arKeys[iKey]).size());
+            }
+            arKey.push_back('\0');
+        }
     }
 
     //--------------------------------------------------------------------------
-    /// Output operator for strings.
+    /// SfCTable::sameHeader
+    /// The tables have the same column names
     //--------------------------------------------------------------------------
-    SfCTable& operator << ( const TString& arValue ) {        ///< Cell value
-        TCell   lCell(arValue, getOpAttr());
-        addCell(lCell);
-        return *this;
-    }
+    bool sameHeader( const SfCTable& arTable ) const {  ///< Other table
+        const TCells&   lrCells  = mpHeader->mCells;
+        const TCells&   lrOthers = arTable.mpHeader->mCells;
 
-    //--------------------------------------------------------------------------
-    //--------------------------------------------------------------------------
-    SfCTable& operator << ( const SAP_UC* apValue ) {        ///< Cell value
-        TCell   lCell(apValue, getOpAttr());
-        addCell(lCell);
-        return *this;
+        if (lrCells.size() != lrOthers.size()) {
+            return false;
+        }
+
+        for (size_t iCell = 0; iCell < lrCells.size(); iCell++) {
+            if (lrCells[iCell].size() != lrOthers[iCell].size() ||
+                memcmp(lrCells[iCell].data(), lrOthers[iCell].data(), lrCells[iCell].size()) != 0) {
+                return false;
+            }
+        }
+        return true;
     }
 
     //--------------------------------------------------------------------------
-    /// Output operators for numeric data.
+    /// SfCTable::collectGroups
+    /// Hashes the data rows by their key values and passes each row with its
+    /// group to the aggregation. The key buffer is reused, so a row of an
+    /// existing group allocates nothing.
     //--------------------------------------------------------------------------
-    SfCTable& operator << ( const SAP_ULLONG aValue ) {     ///< Cell value
-        TAttr           lAttr(getOpAttr());
-        TStringStream   lOs;
+    void collectGroups(
+        vector<TGroup>&         arGroups,           ///< Groups found
+        const vector<size_t>&   arKeys,             ///< Key columns
+        const bool              aDetail,            ///< Keep the rows
+        const std::function<void(TGroup&, const TRow&)>& arAdd ) {   ///< Aggregation
+        std::unordered_map<TString, size_t> lIndex;
+        TString     lKey;
+
+        for (size_t iRow = 1; iRow < mRows.size(); iRow++) {
+            TRow&   lrRow = rowAt(iRow);
+
+            if (!isDataRow(lrRow)) {
+                continue;
+            }
+            rowKey(lrRow, arKeys, lKey);
 
-        TRow&           lrRow = mRows.back();
-        size_t          iCell = lrRow.mCells.size();
+            auto    lIt = lIndex.find(lKey);
 
-        if (mpHeader->mCells.size() > iCell) {
-            lAttr += mpHeader->mCells[iCell].mCellAttr;
-        }
+            if (lIt == lIndex.end()) {
+                lIt = lIndex.insert(std::make_pair(lKey, arGroups.size())).first;
+                arGroups.push_back(TGroup(iRow));
+            }
 
-        if (lAttr.test(HEX)) {
-            lOs << "0x" << setbase(ios_base::hex) << (SAP_UINT)(aValue & 0xFFFFFFFF);
-        }
-        else if (lAttr.test(UNSIGNED)) {
-            lOs << (SAP_ULLONG)aValue;
-        }
-        else {
-            lOs << (SAP_LLONG)aValue;
-        }
-        lAttr.set(NUMBER);
+            TGroup& lrGroup = arGroups[lIt->second];
 
-        TCell  lCell(lOs.str(), lAttr);
-        addCell(lCell);
-        return *this;
+            if (aDetail) {
+                lrGroup.mRows.push_back(iRow);
+            }
+            arAdd(lrGroup, lrRow);
+        }
     }
 
     //--------------------------------------------------------------------------
+    /// SfCTable::copyCell
+    /// Appends the text of a cell to the target. The cell is formatted
+    /// already, so only the alignment flags and the color are kept.
     //--------------------------------------------------------------------------
-    inline SfCTable& operator << ( const SAP_LLONG aValue ) {        ///< Cell value
-        return SfCTable::operator << ((SAP_ULLONG)aValue);
+    static void copyCell(
+        SfCTable&       arTarget,               ///< Target table
+        const TCell&    arCell ) {              ///< Source cell
+        const SAP_UINT  lFlags = (1 << NUMBER) | (1 << UNSIGNED) | (1 << RIGHT) | (1 << LEFT) | (1 << WRAP) |
+                                 (1 << HIGHLIGHT);
+
+        arTarget.addCell(TCell(TString(arCell.data(), arCell.size()),
+            TAttr(arCell.mCellAttr.mFlags & lFlags, arCell.mCellAttr.mColor)));
     }
 
     //--------------------------------------------------------------------------
+    /// SfCTable::addKeyNames
+    /// Header names of the key columns
     //--------------------------------------------------------------------------
-    inline SfCTable& operator << ( const SAP_UINT aValue ) {        ///< Cell value
-        return SfCTable::operator << ((SAP_ULLONG)aValue);
+    void addKeyNames(
+        SfCTable&               arTarget,       ///< Target table
+        const vector<size_t>&   arKeys ) {      ///< Key columns
+        for (size_t iKey = 0; iKey < arKeys.size(); iKey++) {
+            if (arKeys[iKey] < mpHeader->mCells.size()) {
+                copyCell(arTarget, mpHeader->mCells[arKeys[iKey]]);
+            }
+            else {
+                arTarget << "";
+            }
+        }
     }
 
     //--------------------------------------------------------------------------
+    /// SfCTable::addKeyCells
+    /// Starts the row of a group with the key values of its first row
     //--------------------------------------------------------------------------
-    inline SfCTable& operator << ( const SAP_INT aValue ) {        ///< Cell value
-        return SfCTable::operator << ((SAP_ULLONG)aValue);
-    }
+    void addKeyCells(
+        SfCTable&               arTarget,       ///< Target table
+        const vector<size_t>&   arKeys,         ///< Key columns
+        const TGroup&           arGroup ) {     ///< Group
+        TRow&   lrRow = rowAt(arGroup.mFirst);
 
-    //--------------------------------------------------------------------------
-    /// Output operator for numeric data.
-    //--------------------------------------------------------------------------
-    SfCTable& operator << ( const SAP_DOUBLE aValue ) {             ///< Cell value
-        //TRow&        lrRow = mRows.back();
-        size_t  iCell = mRows.back().mCells.size();
-        TAttr   lAttr(getOpAttr());
+        arTarget.row();
 
-        if (mpHeader->mCells.size() > iCell) {
-            lAttr += mpHeader->mCells[iCell].mCellAttr;
+        for (size_t iKey = 0; iKey < arKeys.size(); iKey++) {
+            if (arKeys[iKey] < cellCount(lrRow)) {
+                copyCell(arTarget, cellAt(lrRow, arKeys[iKey]));
+            }
+            else {
+                arTarget << "";
+            }
         }
-        TStringStream lOs;
-
-        lOs << aValue;
-        lAttr.set(NUMBER);
-
-        TCell   lCell(lOs.str(), lAttr);
-
-        addCell(lCell);
-        return *this;
-    }
-
-    //--------------------------------------------------------------------------
-    /// Modification operator for field attributes.
-    //--------------------------------------------------------------------------
-    SfCTable& operator << ( const EFlags& arFlag ) {        ///< the new layout flag value.
-        mOpAttr += arFlag;
-        return *this;
-    }
-
-    //--------------------------------------------------------------------------
-    /// Marks the header as visible.
-    //--------------------------------------------------------------------------
-    SfCTable& hdr( const TAttr&    arAttr = TAttr() ) {    ///< Row attributes
-        mpHeader->mRowAttr.reset(SfCTable::R_INVISIBLE);
-        mpHeader->mRowAttr += arAttr;
-        return *this;
     }
 
     //--------------------------------------------------------------------------
-    /// Appends a data row to the table.
+    /// SfCTable::aggName
+    /// Column name of an aggregate
     //--------------------------------------------------------------------------
-    SfCTable& row( const TAttr&    arAttr = TAttr() ) {    ///< Row attributes
-        //----------------------------------------------------------------------
-        // Check for table overflow.
-        //----------------------------------------------------------------------
-        if (mRows.size() > sPageLength) {
-            //------------------------------------------------------------------
-            // Print the data that is already available.
-            //------------------------------------------------------------------
-            print(PRINT_HEADER);
-            print(PRINT_BODY);
-
-            //------------------------------------------------------------------
-            // Erase the data (non-header, non-subtable) lines.
-            //------------------------------------------------------------------
-            TRows::iterator lIt;
+    TString aggName( const TAgg& arAgg ) {      ///< Aggregate
+        static const SAP_UC* lNames[] = { "count", "sum", "min", "max", "avg" };
 
-            for (lIt = mRows.begin() + 1; lIt != mRows.end(); lIt++) {
-                if (!lIt->mRowAttr.test(R_HEADER) && !lIt->mRowAttr.test(R_SUBTABLE)) {
-                    break;
-                }
-            }
-            mRows.erase(lIt, mRows.end());
+        if (!arAgg.mName.empty()) {
+            return arAgg.mName;
         }
 
-        //----------------------------------------------------------------------
-        // Add a new row, and set that row's header and attributes.
-        //----------------------------------------------------------------------
-        TRow  lRow;
+        if (arAgg.mCol < mpHeader->mCells.size()) {
+            const TCell& lrHdr = mpHeader->mCells[arAgg.mCol];
 
-        lRow.mpHeader = mpHeader;
-        lRow.mRowAttr = arAttr;
-        lRow.mRowAttr |= mAttr.mFlags;
-        mRows.push_back(lRow);
-        return *this;
+            return TString(lNames[arAgg.mType]) + "(" + TString(lrHdr.data(), lrHdr.size()) + ")";
+        }
+        return lNames[arAgg.mType];
     }
 
     //--------------------------------------------------------------------------
-    /// Creates a subtable.
-    /// The current row acts as a placeholder for the subtable in the superior
-    /// table.
+    /// SfCTable::addAggCell
+    /// Appends an aggregate. Whole numbers are shown without exponent, a
+    /// group without values gets an empty cell.
     //--------------------------------------------------------------------------
-    SfCTable* subTable( const TAttr&  arAttr = TAttr() ) {    ///< Subtable attributes
-        row(arAttr);
+    static void addAggCell(
+        SfCTable&       arTarget,               ///< Target table
+        const TAgg&     arAgg,                  ///< Aggregate
+        const TAcc&     arAcc ) {               ///< Aggregated value
+        SAP_DOUBLE  lValue = arAcc.mValue;
+
+        if (arAgg.mType == TAgg::AGG_COUNT) {
+            arTarget << (SAP_ULLONG)arAcc.mCount;
+            return;
+        }
 
-        TRow&        lrRow = mRows.back();
+        if (arAcc.mCount == 0) {
+            arTarget << TAttr(1 << NUMBER) << "";
+            return;
+        }
 
-        lrRow.mRowAttr.set(R_SUBTABLE);
-        lrRow.mpSubTable = new SfCTable("", arAttr);
-        lrRow.mpSubTable->mIndent = mIndent + 4;
-        return lrRow.mpSubTable;
+        if (arAgg.mType == TAgg::AGG_AVG) {
+            lValue /= arAcc.mCount;
+        }
+
+        if (std::isfinite(lValue) && lValue < 1e15 && lValue > -1e15 && lValue == (SAP_DOUBLE)(SAP_LLONG)lValue) {
+            arTarget << (SAP_LLONG)lValue;
+        }
+        else {
+            arTarget << lValue;
+        }
     }
 };
 
@@ -1137,12 +5611,24 @@ TString      SfCTable::sSepStr = "|";
 FILE*        SfCTable::spOut = NULL;
 SAP_CUINT    SfCTable::sMinColWidth = MIN_COL_WIDTH;
 SAP_CUINT    SfCTable::sMaxColWidth = MAX_COL_WIDTH;
-SAP_CUINT    SfCTable::sMaxColCount = MAX_COL_COUNT;
+SAP_UINT     SfCTable::sMaxColCount = MAX_COL_COUNT;
 SAP_CUINT    SfCTable::sMaxRowWidth = MAX_ROW_WIDTH;
 SAP_UINT     SfCTable::sPageLength  = MAX_ROW_COUNT;
-SAP_INT      SfCTable::sTableLength = MAX_ROW_COUNT;
+SAP_INT      SfCTable::sTableLength = 0;
 SAP_UINT     SfCTable::sCurAttr = 0;
 bool         SfCTable::sAlarmed = false;
+SfCAsyncOut* SfCTable::spAsync  = NULL;
+#ifdef SF_ZLIB
+SfCZipOut*   SfCTable::spZip    = NULL;
+#endif
+#ifdef SF_TABLE_STATS
+std::atomic<SAP_ULLONG> SfCTable::sStats[SfCTable::STAT_COUNT];
+#endif
+TString      SfCTable::sInput;
+bool         SfCTable::sInputEof = false;
+SAP_UINT     SfCTable::sTermColors = SfCTable::TERM_COLORS_NONE;
+bool         SfCTable::sTermColorsSet = false;
+TString      SfCTable::sPalette[256];
 
 //------------------------------------------------------------------------------
 /// Output operators for tables.
@@ -1166,4 +5652,6 @@ SfCTable& line(SfCTable& arTable ) {       ///< Table to write to
     return arTable.row(arTable.getOpAttr() + SfCTable::R_LINE);
 }
 
+#include "sfxxtt.hpp"
+
 
@@ -0,0 +1,232 @@
+// -----------------------------------------------------------------
+//
+// Author: Albert Zedlitz
+// File  : sfxxtt.hpp
+// Date  : 11.08.2017
+// Abstract:
+//    Ascii Table
+//    Typed tables with a compile time schema
+//
+// Copyright (C) 2017  Albert Zedlitz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// -----------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include <array>
+#include <type_traits>
+
+#include "sfxxat.hpp"
+
+//------------------------------------------------------------------------------
+/// Flag bits of a typed column, e.g. SfCFlags(SfCTable::HEX, SfCTable::FIXED)
+//------------------------------------------------------------------------------
+constexpr SAP_UINT SfCFlags(void) {
+    return 0;
+}
+
+template<typename... TFlags>
+constexpr SAP_UINT SfCFlags(
+        SfCTable::EFlags    aFlag,              ///< First flag
+        TFlags...           aFlags ) {          ///< Other flags
+    return (1u << aFlag) | SfCFlags(aFlags...);
+}
+
+//==============================================================================
+/// @class SfCColumn
+/// Column of a typed table: value type, layout flags and width. The width is
+/// the minimum width, or the column width with the flag FIXED.
+//==============================================================================
+template<typename T, SAP_UINT aFlags = 0, TStringSize aWidth = MIN_COL_WIDTH>
+struct SfCColumn {
+    typedef T TValue;                           ///< Type of the column values
+
+    static constexpr SAP_UINT    cFlags = aFlags;   ///< Layout flags
+    static constexpr TStringSize cWidth = aWidth;   ///< Column width
+
+    static_assert((aFlags & SfCFlags(SfCTable::DICT, SfCTable::MERGE)) == 0,
+        "SfCColumn: DICT and MERGE are not supported in typed tables");
+    static_assert((aFlags & SfCFlags(SfCTable::FIXED)) == 0 || aWidth > 0,
+        "SfCColumn: a FIXED column needs a width");
+};
+
+//==============================================================================
+/// @class SfCMinWidth
+/// Minimum row width of a typed schema: the column widths and a separator
+/// per column. It is only checked against MAX_ROW_WIDTH at compile time,
+/// the separators and padding are laid out by the renderer of SfCTable.
+//==============================================================================
+template<typename... TCols>
+struct SfCMinWidth {
+    static constexpr TStringSize cValue = 1;
+};
+
+template<typename TCol, typename... TRest>
+struct SfCMinWidth<TCol, TRest...> {
+    static constexpr TStringSize cValue = TCol::cWidth + 1 + SfCMinWidth<TRest...>::cValue;
+};
+
+//==============================================================================
+/// @class SfCTypedTable
+/// Table with a schema that is known at compile time, for fixed format
+/// reports. addRow() takes one value per column and fails to compile for a
+/// wrong count or type. Each column gets a formatter for its type and flags,
+/// so no flags are merged and tested per cell. Printing, paging and all
+/// other functions are those of SfCTable.
+/// @code
+/// typedef SfCColumn<int>                                        TId;
+/// typedef SfCColumn<SAP_UINT, SfCFlags(SfCTable::HEX)>          TMask;
+/// typedef SfCColumn<bool, SfCFlags(SfCTable::YESNO)>            TActive;
+///
+/// SfCTypedTable<TId, TMask, TActive> lTable("Users", {{"id", "mask", "active"}});
+/// lTable.addRow(1, 0xff, true);
+/// @endcode
+//==============================================================================
+template<typename... TCols>
+class SfCTypedTable : public SfCTable
+{
+public:
+    static constexpr size_t cCols = sizeof...(TCols);   ///< Column count
+
+    typedef std::array<const SAP_UC*, sizeof...(TCols)> TNames;
+
+    static_assert(sizeof...(TCols) > 0, "SfCTypedTable: the schema has no columns");
+    static_assert(MAX_COL_COUNT == 0 || sizeof...(TCols) <= MAX_COL_COUNT,
+        "SfCTypedTable: too many columns");
+    static_assert(SfCMinWidth<TCols...>::cValue <= MAX_ROW_WIDTH,
+        "SfCTypedTable: the columns exceed the maximum row width");
+
+    //--------------------------------------------------------------------------
+    /// Constructor. The header takes its flags and widths from the schema.
+    //--------------------------------------------------------------------------
+    SfCTypedTable(
+        const TString&  arHeadLine,             ///< Header line
+        const TNames&   arNames,                ///< Column names
+        const TAttr&    arAttr = TAttr() ):     ///< Attributes
+        SfCTable(arHeadLine, arAttr) {
+        static const TAttr  lAttrs[] = { TAttr(TCols::cFlags, COLOR_NONE, TCols::cWidth)... };
+
+        hdr();
+        for (size_t iCol = 0; iCol < cCols; iCol++) {
+            *this << lAttrs[iCol] << arNames[iCol];
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Appends a data row with one value per column.
+    //--------------------------------------------------------------------------
+    SfCTypedTable& addRow(
+        const typename TCols::TValue&... arValues ) {   ///< Column values
+        row();
+        int lOrder[] = { 0, (put<TCols>(arValues), 0)... };
+
+        (void)lOrder;
+        return *this;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Appends a data row with one value per column and row attributes.
+    //--------------------------------------------------------------------------
+    SfCTypedTable& addRow(
+        const TAttr&    arAttr,                 ///< Row attributes
+        const typename TCols::TValue&... arValues ) {   ///< Column values
+        row(arAttr);
+        int lOrder[] = { 0, (put<TCols>(arValues), 0)... };
+
+        (void)lOrder;
+        return *this;
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Cell attributes of a column. Numbers and booleans are right aligned.
+    //--------------------------------------------------------------------------
+    template<typename TCol>
+    static TAttr attr(void) {
+        return TAttr(TCol::cFlags |
+            (std::is_arithmetic<typename TCol::TValue>::value ? SfCFlags(NUMBER) : 0),
+            COLOR_NONE, TCol::cWidth);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Formats a string column.
+    //--------------------------------------------------------------------------
+    template<typename TCol>
+    void put( const TString& arValue ) {        ///< Value
+        addTyped(TString(arValue), attr<TCol>());
+    }
+
+    template<typename TCol>
+    void put( const SAP_UC* const& apValue ) {  ///< Value
+        addTyped(TString(apValue), attr<TCol>());
+    }
+
+    //--------------------------------------------------------------------------
+    /// Formats a boolean column: true/false, or yes/no with YESNO.
+    //--------------------------------------------------------------------------
+    template<typename TCol>
+    void put( const bool& aValue ) {            ///< Value
+        if ((TCol::cFlags & SfCFlags(YESNO)) != 0) {
+            addTyped(aValue ? TRef("yes", 3) : TRef("no", 2), attr<TCol>());
+        }
+        else {
+            addTyped(aValue ? TRef("true", 4) : TRef("false", 5), attr<TCol>());
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Formats an integer column. HEX shows the lower 32 bits, BOOL and
+    /// YESNO show 0 as false.
+    //--------------------------------------------------------------------------
+    template<typename TCol, typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type
+    put( const T& aValue ) {                    ///< Value
+        SAP_UC      lBuffer[32];
+        SAP_UC*     lpEnd   = lBuffer + sizeof(lBuffer);
+        SAP_UC*     lpStart;
+
+        if ((TCol::cFlags & SfCFlags(BOOL, YESNO)) != 0) {
+            put<TCol>(aValue != 0);
+            return;
+        }
+
+        if ((TCol::cFlags & SfCFlags(HEX)) != 0) {
+            lpStart = digits(lpEnd, (SAP_ULLONG)aValue & 0xFFFFFFFF, 16);
+            *--lpStart = 'x';
+            *--lpStart = '0';
+        }
+        else if (std::is_signed<T>::value && (TCol::cFlags & SfCFlags(UNSIGNED)) == 0 && aValue < 0) {
+            lpStart = digits(lpEnd, 0 - (SAP_ULLONG)aValue, 10);
+            *--lpStart = '-';
+        }
+        else {
+            lpStart = digits(lpEnd, (SAP_ULLONG)aValue, 10);
+        }
+        addTyped(TString(lpStart, lpEnd - lpStart), attr<TCol>());
+    }
+
+    //--------------------------------------------------------------------------
+    /// Formats a floating point column like the stream operators.
+    //--------------------------------------------------------------------------
+    template<typename TCol, typename T>
+    typename std::enable_if<std::is_floating_point<T>::value>::type
+    put( const T& aValue ) {                    ///< Value
+        SAP_UC  lBuffer[32];
+        SAP_INT lLen = snprintf(lBuffer, sizeof(lBuffer), "%g", (SAP_DOUBLE)aValue);
+
+        addTyped(TString(lBuffer, lLen), attr<TCol>());
+    }
+};
@@ -0,0 +1,407 @@
+// -----------------------------------------------------------------
+//
+// Author: Albert Zedlitz
+// File  : sfxxzo.hpp
+// Date  : 11.08.2017
+// Abstract:
+//    Ascii Table
+//    Compressed output
+//
+// Copyright (C) 2017  Albert Zedlitz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+// -----------------------------------------------------------------
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+#ifdef SF_ZSTD
+#include <zstd.h>
+#endif
+
+//==============================================================================
+/// @class SfCZipOut
+/// Compressing sink for redirected output, compiled with SF_ZLIB.
+/// Rendered lines are collected into large blocks, so the compressor sees
+/// long runs of padding and separators. A block is compressed in the calling
+/// thread or, with aThread, by a compressor thread while the next block is
+/// collected. gzip files need zlib, zstd files need SF_ZSTD and libzstd.
+/// view() decompresses a file of either format for reading.
+//==============================================================================
+class SfCZipOut
+{
+public:
+    //--------------------------------------------------------------------------
+    /// @enum EFormat
+    /// Compression format of the file.
+    //--------------------------------------------------------------------------
+    typedef enum EFormat {
+        ZIP_GZIP,              ///< gzip file, readable by gzip and zcat
+        ZIP_ZSTD               ///< zstd frame, needs SF_ZSTD
+    } EFormat;
+
+private:
+    //--------------------------------------------------------------------------
+    /// @enum EFlush
+    /// Position of a block in the stream.
+    //--------------------------------------------------------------------------
+    typedef enum EFlush {
+        FLUSH_NONE,            ///< more data follows
+        FLUSH_SYNC,            ///< make all data readable
+        FLUSH_END              ///< end of the stream
+    } EFlush;
+
+    typedef std::pair<TString, EFlush> TBlock;
+
+    FILE*                       mpFile;     ///< compressed file
+    EFormat                     mFormat;    ///< compression format
+    size_t                      mBlockSize; ///< collected bytes per block
+    TString                     mBlock;     ///< block being collected
+    std::vector<unsigned char>  mOut;       ///< compressor output buffer
+    z_stream                    mZip;       ///< gzip stream
+#ifdef SF_ZSTD
+    ZSTD_CStream*               mpZstd;     ///< zstd stream
+#endif
+    bool                        mOk;        ///< no compression error
+    std::mutex                  mWrite;     ///< serializes printing threads
+
+    bool                        mThreaded;  ///< blocks go to the thread
+    std::thread                 mThread;    ///< compressor thread
+    std::mutex                  mMutex;     ///< protects the queue
+    std::condition_variable     mCondWork;  ///< a block is queued
+    std::condition_variable     mCondDone;  ///< a block is compressed
+    std::deque<TBlock>          mQueue;     ///< blocks to compress
+    size_t                      mPending;   ///< blocks queued or in work
+    bool                        mStop;      ///< the thread shall terminate
+
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor. The file stays open after the sink is destroyed.
+    //--------------------------------------------------------------------------
+    SfCZipOut(
+        FILE*           apFile,                 ///< Target file
+        const EFormat   aFormat = ZIP_GZIP,     ///< Compression format
+        const SAP_INT   aLevel = 6,             ///< Compression level
+        const bool      aThread = false,        ///< Compress in a thread
+        const size_t    aBlockSize = 1 << 20 ): ///< Bytes per block
+        mpFile(apFile),
+        mFormat(aFormat),
+        mBlockSize(aBlockSize),
+        mOut(256 * 1024),
+#ifdef SF_ZSTD
+        mpZstd(NULL),
+#endif
+        mOk(false),
+        mThreaded(aThread),
+        mPending(0),
+        mStop(false) {
+        memset(&mZip, 0, sizeof(mZip));
+        mBlock.reserve(mBlockSize);
+
+        if (mFormat == ZIP_GZIP) {
+            mOk = deflateInit2(&mZip, aLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+#ifdef SF_ZSTD
+        else if ((mpZstd = ZSTD_createCStream()) != NULL) {
+            mOk = !ZSTD_isError(ZSTD_initCStream(mpZstd, aLevel));
+        }
+#endif
+
+        if (mOk && mThreaded) {
+            mThread = std::thread(&SfCZipOut::run, this);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Destructor. Compresses the rest and ends the stream.
+    //--------------------------------------------------------------------------
+    ~SfCZipOut() {
+        if (mOk) {
+            push(FLUSH_END);
+        }
+
+        if (mThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lLock(mMutex);
+                mStop = true;
+            }
+            mCondWork.notify_all();
+            mThread.join();
+        }
+
+        if (mFormat == ZIP_GZIP) {
+            deflateEnd(&mZip);
+        }
+#ifdef SF_ZSTD
+        if (mpZstd != NULL) {
+            ZSTD_freeCStream(mpZstd);
+        }
+#endif
+        fflush(mpFile);
+    }
+
+    //--------------------------------------------------------------------------
+    /// The format is supported and no error occurred.
+    //--------------------------------------------------------------------------
+    bool isOk(void) const {
+        return mOk;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Adds rendered output. A full block is compressed.
+    //--------------------------------------------------------------------------
+    void write( const TString& arData ) {       ///< Rendered output
+        std::lock_guard<std::mutex> lLock(mWrite);
+
+        mBlock.append(arData);
+
+        if (mBlock.size() >= mBlockSize) {
+            push(FLUSH_NONE);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Compresses all output so far and writes it to the file, so that a
+    /// reader sees complete lines.
+    //--------------------------------------------------------------------------
+    void flush(void) {
+        std::lock_guard<std::mutex> lWriteLock(mWrite);
+
+        push(FLUSH_SYNC);
+
+        if (mThreaded) {
+            std::unique_lock<std::mutex> lLock(mMutex);
+
+            mCondDone.wait(lLock, [this] { return mPending == 0; });
+        }
+        fflush(mpFile);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Decompresses a gzip or zstd file into the output file, e.g. stdout.
+    /// The format is told by the file, other files are copied unchanged.
+    /// @return false if the file is damaged or the format is not supported
+    //--------------------------------------------------------------------------
+    static bool view(
+        FILE*           apIn,                   ///< Compressed file
+        FILE*           apOut ) {               ///< Output file
+        std::vector<unsigned char>  lIn(256 * 1024);
+        std::vector<unsigned char>  lOut(256 * 1024);
+        size_t          lSize = fread(lIn.data(), 1, 4, apIn);
+
+        if (lSize >= 4 && lIn[0] == 0x28 && lIn[1] == 0xB5 && lIn[2] == 0x2F && lIn[3] == 0xFD) {
+            return viewZstd(apIn, apOut, lIn, lOut, lSize);
+        }
+
+        if (lSize < 2 || lIn[0] != 0x1F || lIn[1] != 0x8B) {
+            do {
+                fwrite(lIn.data(), 1, lSize, apOut);
+            } while ((lSize = fread(lIn.data(), 1, lIn.size(), apIn)) > 0);
+            return true;
+        }
+
+        z_stream    lZip;
+        SAP_INT     lRet = Z_OK;
+
+        memset(&lZip, 0, sizeof(lZip));
+
+        if (inflateInit2(&lZip, 15 + 32) != Z_OK) {
+            return false;
+        }
+
+        do {
+            lZip.next_in  = lIn.data();
+            lZip.avail_in = (uInt)lSize;
+
+            for (;;) {
+                //--------------------------------------------------------------
+                // A file may hold several gzip members, e.g. appended dumps.
+                //--------------------------------------------------------------
+                if (lRet == Z_STREAM_END) {
+                    if (lZip.avail_in == 0) {
+                        break;
+                    }
+                    inflateReset(&lZip);
+                }
+                lZip.next_out  = lOut.data();
+                lZip.avail_out = (uInt)lOut.size();
+                lRet = inflate(&lZip, Z_NO_FLUSH);
+
+                if (lRet != Z_OK && lRet != Z_STREAM_END && lRet != Z_BUF_ERROR) {
+                    inflateEnd(&lZip);
+                    return false;
+                }
+                fwrite(lOut.data(), 1, lOut.size() - lZip.avail_out, apOut);
+
+                if (lRet == Z_BUF_ERROR || (lZip.avail_in == 0 && lZip.avail_out > 0)) {
+                    break;
+                }
+            }
+        } while ((lSize = fread(lIn.data(), 1, lIn.size(), apIn)) > 0);
+
+        inflateEnd(&lZip);
+        return lRet == Z_STREAM_END;
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Hands the collected block to the thread or compresses it.
+    //--------------------------------------------------------------------------
+    void push( const EFlush aFlush ) {          ///< Position in the stream
+        TBlock  lBlock(std::move(mBlock), aFlush);
+
+        mBlock = TString();
+        mBlock.reserve(mBlockSize);
+
+        if (!mThreaded) {
+            compress(lBlock.first, lBlock.second);
+            return;
+        }
+
+        //----------------------------------------------------------------------
+        // One block in work and one queued: the caller waits instead of
+        // collecting more memory than that.
+        //----------------------------------------------------------------------
+        std::unique_lock<std::mutex> lLock(mMutex);
+
+        mCondDone.wait(lLock, [this] { return mPending < 2; });
+        mQueue.push_back(std::move(lBlock));
+        mPending++;
+        mCondWork.notify_one();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Compressor thread.
+    //--------------------------------------------------------------------------
+    void run(void) {
+        std::unique_lock<std::mutex> lLock(mMutex);
+
+        for (;;) {
+            mCondWork.wait(lLock, [this] { return !mQueue.empty() || mStop; });
+
+            if (mQueue.empty()) {
+                break;
+            }
+
+            TBlock  lBlock = std::move(mQueue.front());
+
+            mQueue.pop_front();
+            lLock.unlock();
+            compress(lBlock.first, lBlock.second);
+            lLock.lock();
+            mPending--;
+            mCondDone.notify_all();
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Compresses a block and writes the result.
+    //--------------------------------------------------------------------------
+    void compress(
+        const TString&  arData,                 ///< Block
+        const EFlush    aFlush ) {              ///< Position in the stream
+        if (!mOk) {
+            return;
+        }
+
+        if (mFormat == ZIP_GZIP) {
+            SAP_INT lMode = (aFlush == FLUSH_END) ? Z_FINISH : (aFlush == FLUSH_SYNC) ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+            SAP_INT lRet;
+
+            mZip.next_in  = (Bytef*)arData.data();
+            mZip.avail_in = (uInt)arData.size();
+
+            do {
+                mZip.next_out  = mOut.data();
+                mZip.avail_out = (uInt)mOut.size();
+                lRet = deflate(&mZip, lMode);
+                fwrite(mOut.data(), 1, mOut.size() - mZip.avail_out, mpFile);
+            } while (mZip.avail_out == 0 || (lMode == Z_FINISH && lRet == Z_OK));
+
+            mOk = (lRet != Z_STREAM_ERROR);
+            return;
+        }
+#ifdef SF_ZSTD
+        ZSTD_EndDirective   lMode = (aFlush == FLUSH_END) ? ZSTD_e_end : (aFlush == FLUSH_SYNC) ? ZSTD_e_flush : ZSTD_e_continue;
+        ZSTD_inBuffer       lIn   = { arData.data(), arData.size(), 0 };
+        size_t              lLeft;
+
+        do {
+            ZSTD_outBuffer  lOut = { mOut.data(), mOut.size(), 0 };
+
+            lLeft = ZSTD_compressStream2(mpZstd, &lOut, &lIn, lMode);
+
+            if (ZSTD_isError(lLeft)) {
+                mOk = false;
+                return;
+            }
+            fwrite(mOut.data(), 1, lOut.pos, mpFile);
+        } while (lIn.pos < lIn.size || (lMode != ZSTD_e_continue && lLeft > 0));
+#endif
+    }
+
+    //--------------------------------------------------------------------------
+    /// Decompresses a zstd file, see view().
+    //--------------------------------------------------------------------------
+    static bool viewZstd(
+        FILE*                       apIn,       ///< Compressed file
+        FILE*                       apOut,      ///< Output file
+        std::vector<unsigned char>& arIn,       ///< Input buffer
+        std::vector<unsigned char>& arOut,      ///< Output buffer
+        size_t                      aSize ) {   ///< Bytes in the input buffer
+#ifdef SF_ZSTD
+        ZSTD_DStream*   lpZstd = ZSTD_createDStream();
+        size_t          lRet   = 0;
+
+        if (lpZstd == NULL || ZSTD_isError(ZSTD_initDStream(lpZstd))) {
+            ZSTD_freeDStream(lpZstd);
+            return false;
+        }
+
+        do {
+            ZSTD_inBuffer   lIn = { arIn.data(), aSize, 0 };
+
+            for (;;) {
+                ZSTD_outBuffer  lOut = { arOut.data(), arOut.size(), 0 };
+
+                lRet = ZSTD_decompressStream(lpZstd, &lOut, &lIn);
+
+                if (ZSTD_isError(lRet)) {
+                    ZSTD_freeDStream(lpZstd);
+                    return false;
+                }
+                fwrite(arOut.data(), 1, lOut.pos, apOut);
+
+                if (lIn.pos == lIn.size && lOut.pos < lOut.size) {
+                    break;
+                }
+            }
+        } while ((aSize = fread(arIn.data(), 1, arIn.size(), apIn)) > 0);
+
+        ZSTD_freeDStream(lpZstd);
+        return lRet == 0;
+#else
+        (void)apIn; (void)apOut; (void)arIn; (void)arOut; (void)aSize;
+        return false;
+#endif
+    }
+};